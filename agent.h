@@ -0,0 +1,17 @@
+#pragma once
+
+#include "rules.h"
+#include <random>
+
+// Anything that can pick a move for state.toMove. Agents are not shared
+// between threads; batch runners create one per worker and pass in that
+// worker's RNG.
+class Agent {
+public:
+    virtual ~Agent() = default;
+    virtual Move chooseMove(const GameState& state, std::mt19937& rng) = 0;
+
+    // Search nodes created over every move so far, for speed comparisons;
+    // agents that do not search report 0.
+    virtual long long nodesSearched() const { return 0; }
+};
@@ -0,0 +1,37 @@
+#include "agent_registry.h"
+
+#include "greedy_ai.h"
+#include "mcts.h"
+#include "random_ai.h"
+#include <cstdlib>
+
+AgentFactory findAgent(const std::string& spec, const Tablebase* tablebase) {
+    if (spec == "random") {
+        return [] { return std::unique_ptr<Agent>(new RandomAgent()); };
+    }
+    if (spec == "greedy" || spec.compare(0, 7, "greedy:") == 0) {
+        double greediness = spec.size() > 7 ? std::atof(spec.c_str() + 7) / 100.0 : 1.0;
+        return [greediness] { return std::unique_ptr<Agent>(new GreedyAgent(greediness)); };
+    }
+    if (spec == "mcts" || spec.compare(0, 5, "mcts:") == 0) {
+        MctsConfig config;
+        config.tablebase = tablebase;
+        if (spec.size() > 5) {
+            config.timeBudget = std::atof(spec.c_str() + 5) / 1000.0;
+        }
+        size_t threads = spec.find('x', 5);
+        if (threads != std::string::npos) {
+            config.threads = std::atoi(spec.c_str() + threads + 1);
+        }
+        size_t greedy = spec.find('g', 5);
+        if (greedy != std::string::npos) {
+            config.greedyPlayouts = std::atof(spec.c_str() + greedy + 1) / 100.0;
+        }
+        return [config] { return std::unique_ptr<Agent>(new MctsAgent(config)); };
+    }
+    return AgentFactory();
+}
+
+const char* agentNames() {
+    return "random, greedy[:<greedy %>], mcts[:<think ms>[x<threads>][g<greedy playout %>]]";
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "tournament.h"
+#include <string>
+
+class Tablebase;
+
+// Builds a factory for the agent named by spec, e.g. "random", "mcts:250"
+// (MCTS with a 250 ms budget) or "mcts:250x4" (the same, searching four trees
+// on the shared pool), "mcts:250g30" (playouts picking 30% of their moves
+// greedily) or "greedy:70" (greedy for 70% of moves, random otherwise).
+// Returns an empty factory for unknown names.
+// MCTS agents answer positions in tablebase, if given, without searching.
+AgentFactory findAgent(const std::string& spec, const Tablebase* tablebase = nullptr);
+
+// Comma-separated list of accepted names, for usage messages.
+const char* agentNames();
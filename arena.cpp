@@ -0,0 +1,51 @@
+#include "arena.h"
+
+#include <algorithm>
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    while (current < blocks.size()) {
+        Block& block = blocks[current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.bytes.get());
+        size_t start = ((base + used + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+        if (start + bytes <= block.size) {
+            used = start + bytes;
+            return block.bytes.get() + start;
+        }
+        // the rest of this block is left unused until the next rewind
+        current++;
+        used = 0;
+    }
+
+    size_t size = std::max(blockBytes, bytes + alignment);
+    blocks.push_back(Block{std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+    current = blocks.size() - 1;
+    used = 0;
+    return allocate(bytes, alignment);
+}
+
+bool Arena::extend(void* data, size_t oldBytes, size_t newBytes) {
+    if (current >= blocks.size()) return false;
+    Block& block = blocks[current];
+    uint8_t* start = static_cast<uint8_t*>(data);
+    if (start + oldBytes != block.bytes.get() + used) return false;
+    size_t offset = static_cast<size_t>(start - block.bytes.get());
+    if (offset + newBytes > block.size) return false;
+    used = offset + newBytes;
+    return true;
+}
+
+void Arena::rewind(const Mark& mark) {
+    current = mark.block;
+    used = mark.used;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks) total += block.size;
+    return total;
+}
+
+Arena& threadArena() {
+    thread_local Arena arena;
+    return arena;
+}
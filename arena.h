@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for search temporaries. Allocation is a pointer bump inside
+// the current block; freeing is rewinding to a mark, which keeps every block
+// for the next search instead of returning it to the heap. A thread that
+// searches all day therefore stops allocating once its arena has grown to
+// the largest search it has run.
+//
+// Marks nest, so a search that starts while another on the same thread is
+// still using its memory (as a pool thread helping out can) stacks on top of
+// it and rewinds back to where it began.
+class Arena {
+public:
+    struct Mark {
+        size_t block;
+        size_t used;
+    };
+
+    explicit Arena(size_t blockBytes = 1 << 20) : blockBytes(blockBytes) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment);
+
+    // Uninitialised room for count objects; T must not need destroying.
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "an arena never runs destructors");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Grows the most recent allocation, at data with oldBytes, to newBytes
+    // where it stands; false, changing nothing, if it is not the most recent
+    // or its block is too small.
+    bool extend(void* data, size_t oldBytes, size_t newBytes);
+
+    Mark mark() const { return Mark{current, used}; }
+    void rewind(const Mark& mark);
+
+    // Bytes held in blocks, in use or not.
+    size_t capacity() const;
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> bytes;
+        size_t size;
+    };
+
+    size_t blockBytes;
+    std::vector<Block> blocks;
+    size_t current = 0;  // block being bumped; blocks past it are free
+    size_t used = 0;     // bytes taken from blocks[current]
+};
+
+// Rewinds the arena to where it was when the scope opened.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : arena(arena), start(arena.mark()) {}
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    ~ArenaScope() { arena.rewind(start); }
+
+private:
+    Arena& arena;
+    Arena::Mark start;
+};
+
+// The calling thread's arena, for temporaries that live no longer than one
+// search on that thread.
+Arena& threadArena();
+
+// Growable, contiguous array of trivially copyable T in an arena. Growth
+// doubles the capacity in place when the array is the arena's most recent
+// allocation and its block has room, which is the common case for the one
+// big array of a search; otherwise it moves to a fresh allocation and the
+// old space waits for the next rewind. clear() keeps the capacity.
+template <typename T>
+class ArenaVector {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "elements are stored without constructors");
+
+    explicit ArenaVector(Arena& arena, int initialCapacity = 256) : arena(&arena), capacity(initialCapacity) {
+        items = arena.allocateArray<T>(static_cast<size_t>(capacity));
+    }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() { count = 0; }
+
+    T& operator[](int i) { return items[i]; }
+    const T& operator[](int i) const { return items[i]; }
+    T& back() { return items[count - 1]; }
+
+    void push_back(const T& value) {
+        if (count == capacity) grow();
+        items[count++] = value;
+    }
+
+private:
+    void grow() {
+        size_t bytes = sizeof(T) * static_cast<size_t>(capacity);
+        if (!arena->extend(items, bytes, 2 * bytes)) {
+            T* moved = arena->allocateArray<T>(2 * static_cast<size_t>(capacity));
+            std::memcpy(moved, items, bytes);
+            items = moved;
+        }
+        capacity *= 2;
+    }
+
+    Arena* arena;
+    T* items;
+    int capacity;
+    int count = 0;
+};
@@ -0,0 +1,150 @@
+#include "asset_bundle.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const uint8_t MAGIC[4] = {'T', 'P', 'A', 'K'};
+const uint32_t VERSION = 1;
+const size_t HEADER_BYTES = 12;
+const size_t ALIGNMENT = 16;
+
+template <typename T>
+T readAt(const uint8_t* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) return false;
+    out.clear();
+    uint8_t buffer[1 << 16];
+    size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), in)) > 0) out.insert(out.end(), buffer, buffer + got);
+    bool ok = !std::ferror(in);
+    std::fclose(in);
+    return ok;
+}
+
+}
+
+bool AssetBundle::open(const char* path) {
+    close();
+    if (!file.open(path, MapAccess::SEQUENTIAL)) return false;
+    bytes = file.data();
+    length = file.size();
+    if (!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool AssetBundle::openMemory(const uint8_t* data, size_t size) {
+    close();
+    bytes = data;
+    length = size;
+    if (!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetBundle::close() {
+    file.close();
+    bytes = nullptr;
+    length = 0;
+    entries.clear();
+}
+
+bool AssetBundle::parse() {
+    if (!bytes || length < HEADER_BYTES || std::memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0 ||
+        readAt<uint32_t>(bytes + 4) != VERSION) {
+        return false;
+    }
+    uint32_t count = readAt<uint32_t>(bytes + 8);
+    size_t at = HEADER_BYTES;
+    entries.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (length - at < 20) return false;
+        Entry entry;
+        entry.offset = readAt<uint64_t>(bytes + at);
+        entry.size = readAt<uint64_t>(bytes + at + 8);
+        uint32_t nameLength = readAt<uint32_t>(bytes + at + 16);
+        at += 20;
+        if (length - at < nameLength || entry.offset > length || entry.size > length - entry.offset) return false;
+        entry.name.assign(reinterpret_cast<const char*>(bytes + at), nameLength);
+        at += nameLength;
+        entries.push_back(std::move(entry));
+    }
+    return std::is_sorted(entries.begin(), entries.end(),
+                          [](const Entry& a, const Entry& b) { return a.name < b.name; });
+}
+
+bool AssetBundle::find(const std::string& name, AssetView& asset) const {
+    auto entry = std::lower_bound(entries.begin(), entries.end(), name,
+                                  [](const Entry& e, const std::string& key) { return e.name < key; });
+    if (entry == entries.end() || entry->name != name) return false;
+    asset.data = bytes + entry->offset;
+    asset.size = static_cast<size_t>(entry->size);
+    return true;
+}
+
+bool writeAssetBundle(const char* path, const std::vector<AssetSource>& sources, std::string& error) {
+    std::vector<AssetSource> sorted = sources;
+    std::sort(sorted.begin(), sorted.end(), [](const AssetSource& a, const AssetSource& b) { return a.name < b.name; });
+    for (size_t i = 1; i < sorted.size(); i++) {
+        if (sorted[i].name == sorted[i - 1].name) {
+            error = "asset " + sorted[i].name + " listed twice";
+            return false;
+        }
+    }
+
+    size_t directoryBytes = 0;
+    for (const AssetSource& source : sorted) directoryBytes += 20 + source.name.size();
+    std::vector<uint8_t> header;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> contents;
+    size_t dataStart = (HEADER_BYTES + directoryBytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+    header.insert(header.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    append(header, VERSION);
+    append(header, static_cast<uint32_t>(sorted.size()));
+    for (const AssetSource& source : sorted) {
+        if (!readFile(source.path, contents)) {
+            error = "cannot read " + source.path;
+            return false;
+        }
+        data.resize((data.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, 0);
+        append(header, static_cast<uint64_t>(dataStart + data.size()));
+        append(header, static_cast<uint64_t>(contents.size()));
+        append(header, static_cast<uint32_t>(source.name.size()));
+        header.insert(header.end(), source.name.begin(), source.name.end());
+        data.insert(data.end(), contents.begin(), contents.end());
+    }
+    header.resize(dataStart, 0);
+
+    FILE* out = std::fopen(path, "wb");
+    if (!out) {
+        error = std::string("cannot write ") + path;
+        return false;
+    }
+    bool ok = std::fwrite(header.data(), 1, header.size(), out) == header.size() &&
+              std::fwrite(data.data(), 1, data.size(), out) == data.size();
+    if (std::fclose(out) != 0 || !ok) {
+        error = std::string("cannot write ") + path;
+        return false;
+    }
+    return true;
+}
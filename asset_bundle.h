@@ -0,0 +1,60 @@
+#pragma once
+
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One packed asset: a view into the bundle's bytes, valid while it is open.
+struct AssetView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Every asset the client ships, packed by terra_pack into one file that is
+// either memory-mapped at startup or compiled into the executable. Assets
+// keep their files' bytes, compressed as they were, and are read in place:
+// raylib's from-memory loaders decode straight out of the mapping.
+//
+//   header     "TPAK" then u32 version and entry count
+//   directory  per entry, sorted by name: u64 offset, u64 size, u32 name
+//              length and the name, a path such as "assets/sounds/Key.mp3"
+//   data       each asset at a 16-byte aligned offset from the file start
+class AssetBundle {
+public:
+    bool open(const char* path);
+    // Reads a bundle that stays in memory for as long as this is open, the
+    // copy embedded in the executable for instance.
+    bool openMemory(const uint8_t* data, size_t size);
+    void close();
+    bool loaded() const { return bytes != nullptr; }
+
+    int count() const { return static_cast<int>(entries.size()); }
+    bool find(const std::string& name, AssetView& asset) const;
+
+private:
+    struct Entry {
+        std::string name;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    bool parse();
+
+    MappedFile file;
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+    std::vector<Entry> entries;
+};
+
+// A file to pack: the name it is found by and where it is read from now.
+struct AssetSource {
+    std::string name;
+    std::string path;
+};
+
+// Packs sources into a bundle at path. False, with error saying which, when a
+// source cannot be read or the output cannot be written; a missing asset is
+// a build failure, not something the client finds out at startup.
+bool writeAssetBundle(const char* path, const std::vector<AssetSource>& sources, std::string& error);
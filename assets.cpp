@@ -0,0 +1,103 @@
+#include "assets.h"
+
+void SoundCache::start(const std::vector<std::string>& paths, const AssetBundle* bundle) {
+    unload();
+    for (const std::string& path : paths) {
+        if (find(path)) continue;
+        entries.emplace_back(new Entry());
+        entries.back()->path = path;
+    }
+    cancel.store(false);
+    complete = false;
+
+    // decoding is plain CPU work; only creating the audio buffers needs the main thread
+    loader = std::thread([this, bundle] {
+        for (std::unique_ptr<Entry>& entry : entries) {
+            if (cancel.load()) return;
+            AssetView packed;
+            if (bundle && bundle->find(entry->path, packed)) {
+                entry->bytes = packed.data;
+                entry->size = static_cast<int>(packed.size);
+            } else {
+                entry->fileData = LoadFileData(entry->path.c_str(), &entry->size);
+                entry->bytes = entry->fileData;
+            }
+            if (entry->bytes) {
+                entry->wave = LoadWaveFromMemory(GetFileExtension(entry->path.c_str()), entry->bytes, entry->size);
+            }
+            entry->decoded.store(true, std::memory_order_release);
+        }
+    });
+}
+
+bool SoundCache::poll() {
+    if (complete) return true;
+
+    bool pending = false;
+    for (std::unique_ptr<Entry>& entry : entries) {
+        if (entry->uploaded) continue;
+        if (!entry->decoded.load(std::memory_order_acquire)) {
+            pending = true;
+            continue;
+        }
+        if (entry->wave.data) {
+            entry->sound = LoadSoundFromWave(entry->wave);
+            UnloadWave(entry->wave);
+            entry->wave = Wave{};
+        }
+        if (entry->sound.stream.buffer == NULL) {
+            TraceLog(LOG_WARNING, "Failed to load %s", entry->path.c_str());
+        }
+        entry->uploaded = true;
+    }
+
+    if (!pending) {
+        loader.join();
+        complete = true;
+    }
+    return complete;
+}
+
+SoundCache::Entry* SoundCache::find(const std::string& path) {
+    for (std::unique_ptr<Entry>& entry : entries) {
+        if (entry->path == path) return entry.get();
+    }
+    return nullptr;
+}
+
+Sound SoundCache::sound(const std::string& path) {
+    Entry* entry = find(path);
+    if (!entry || !entry->uploaded || entry->sound.stream.buffer == NULL) return Sound{};
+    if (!entry->handedOut) {
+        entry->handedOut = true;
+        return entry->sound;
+    }
+    aliases.push_back(LoadSoundAlias(entry->sound));
+    return aliases.back();
+}
+
+Music SoundCache::music(const std::string& path) {
+    Entry* entry = find(path);
+    if (!entry || !entry->uploaded || !entry->bytes) return Music{};
+    // the stream decodes from entry->bytes as it plays, so they stay until unload()
+    Music music = LoadMusicStreamFromMemory(GetFileExtension(entry->path.c_str()), entry->bytes, entry->size);
+    if (music.stream.buffer != NULL) streams.push_back(music);
+    return music;
+}
+
+void SoundCache::unload() {
+    cancel.store(true);
+    if (loader.joinable()) loader.join();
+
+    for (Music& music : streams) UnloadMusicStream(music);
+    for (Sound& alias : aliases) UnloadSoundAlias(alias);
+    for (std::unique_ptr<Entry>& entry : entries) {
+        if (entry->sound.stream.buffer != NULL) UnloadSound(entry->sound);
+        if (entry->wave.data) UnloadWave(entry->wave);
+        if (entry->fileData) UnloadFileData(entry->fileData);
+    }
+    streams.clear();
+    aliases.clear();
+    entries.clear();
+    complete = false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "asset_bundle.h"
+#include "raylib.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads and decodes every sound file once, off the main thread. start() hands
+// the file list to a loader thread and returns at once, so the menu can show
+// while MP3s decode; poll() on the main thread turns decoded files into
+// Sounds as they finish. sound() gives out the first Sound of a file and
+// LoadSoundAlias copies of it after that, all sharing one sample buffer;
+// music() streams from the same file bytes instead of reopening the file.
+// Files found in the bundle given to start() are decoded in place from it
+// and never touch the file system; the rest are read from disk.
+class SoundCache {
+public:
+    SoundCache() = default;
+    SoundCache(const SoundCache&) = delete;
+    SoundCache& operator=(const SoundCache&) = delete;
+    ~SoundCache() { unload(); }
+
+    // bundle, if given, must stay open until unload().
+    void start(const std::vector<std::string>& paths, const AssetBundle* bundle = nullptr);
+    // True once every file has been loaded or has failed to.
+    bool poll();
+
+    // A playable handle on path, or an empty Sound if it failed to load.
+    Sound sound(const std::string& path);
+    Music music(const std::string& path);
+
+    // Stops the loader and frees every Sound, alias and Music handed out.
+    void unload();
+
+private:
+    struct Entry {
+        std::string path;
+        const unsigned char* bytes = nullptr;  // into the bundle, or fileData
+        unsigned char* fileData = nullptr;
+        int size = 0;
+        Wave wave = {};
+        std::atomic<bool> decoded{false};  // set by the loader, bytes and wave then belong to the main thread
+        bool uploaded = false;
+        Sound sound = {};
+        bool handedOut = false;
+    };
+
+    Entry* find(const std::string& path);
+
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::vector<Sound> aliases;
+    std::vector<Music> streams;
+    std::thread loader;
+    std::atomic<bool> cancel{false};
+    bool complete = false;
+};
@@ -0,0 +1,219 @@
+#include "bitboard.h"
+#include "fixed_board.h"
+#include "greedy_ai.h"
+#include "mcts.h"
+#include "random_ai.h"
+#include "thread_pool.h"
+#include "tournament.h"
+
+#include <benchmark/benchmark.h>
+#include <map>
+#include <utility>
+
+// Micro benchmarks take {board size, percent of cells owned}; the densities
+// stand for early, mid and late game. Positions come from random self-play
+// with the win check switched off, so late boards can be filled past 45%.
+
+namespace {
+
+const std::vector<int64_t> SIZES = {7, 10, 12, 256};
+const std::vector<int64_t> DENSITIES = {10, 40, 80};
+
+GameState buildPosition(int size, int fillPercent) {
+    Rules rules;
+    rules.gridSize = size;
+    rules.winPercentage = 100;
+
+    GameState state;
+    state.reset(rules);
+    std::mt19937 rng(static_cast<uint32_t>(size * 1000 + fillPercent));
+    int wanted = state.board.cellCount() * fillPercent / 100;
+    int moveLimit = 20 * state.board.cellCount();
+    for (int moves = 0; moves < moveLimit && !state.isOver(); moves++) {
+        if (state.cells(CellState::PLAYER) + state.cells(CellState::AI) >= wanted) break;
+        applyMove(state, chooseRandomMove(state, rng));
+    }
+
+    state.rules.winPercentage = WIN_PERCENTAGE;
+    return state;
+}
+
+// Building a late 256x256 position takes a while, so each one is built once.
+const GameState& position(const benchmark::State& state) {
+    static std::map<std::pair<int, int>, GameState> cache;
+    std::pair<int, int> key(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    auto found = cache.find(key);
+    if (found == cache.end()) {
+        found = cache.emplace(key, buildPosition(key.first, key.second)).first;
+    }
+    return found->second;
+}
+
+void BM_ForEachNeighbor(benchmark::State& state) {
+    const Board& board = position(state).board;
+    for (auto _ : state) {
+        int owned = 0;
+        for (int cell = 0; cell < board.cellCount(); cell++) {
+            board.forEachNeighbor(cell, [&](int neighbor) { owned += board.at(neighbor) != CellState::NEUTRAL; });
+        }
+        benchmark::DoNotOptimize(owned);
+    }
+    state.SetItemsProcessed(state.iterations() * board.cellCount());
+}
+BENCHMARK(BM_ForEachNeighbor)->ArgsProduct({SIZES, DENSITIES});
+
+void BM_IsLegalCapture(benchmark::State& state) {
+    const GameState& game = position(state);
+    int cells = game.board.cellCount();
+    for (auto _ : state) {
+        int legal = 0;
+        for (int cell = 0; cell < cells; cell++) {
+            legal += isLegalCapture(game, CellState::PLAYER, cell);
+        }
+        benchmark::DoNotOptimize(legal);
+    }
+    state.SetItemsProcessed(state.iterations() * cells);
+}
+BENCHMARK(BM_IsLegalCapture)->ArgsProduct({SIZES, DENSITIES});
+
+// Available captures as the engine keeps them: walking the incremental set.
+void BM_FrontierSet(benchmark::State& state) {
+    const Board& board = position(state).board;
+    for (auto _ : state) {
+        int sum = 0;
+        for (int cell : board.frontier(CellState::PLAYER)) sum += cell;
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_FrontierSet)->ArgsProduct({SIZES, DENSITIES});
+
+// The same captures recomputed from scratch by bit-plane dilation.
+void BM_FrontierBitBoard(benchmark::State& state) {
+    BitBoard board;
+    board.load(position(state).board);
+    std::vector<uint64_t> mask(board.wordCount());
+    for (auto _ : state) {
+        board.frontier(CellState::PLAYER, mask.data());
+        benchmark::DoNotOptimize(mask.data());
+    }
+}
+BENCHMARK(BM_FrontierBitBoard)->ArgsProduct({SIZES, DENSITIES});
+
+template <int N>
+void BM_FrontierFixed(benchmark::State& state) {
+    FixedBoard<N> board;
+    board.load(position(state).board);
+    for (auto _ : state) {
+        auto mask = board.frontier(CellState::PLAYER);
+        benchmark::DoNotOptimize(mask);
+    }
+}
+BENCHMARK_TEMPLATE(BM_FrontierFixed, 7)->ArgsProduct({{7}, DENSITIES});
+BENCHMARK_TEMPLATE(BM_FrontierFixed, 10)->ArgsProduct({{10}, DENSITIES});
+BENCHMARK_TEMPLATE(BM_FrontierFixed, 12)->ArgsProduct({{12}, DENSITIES});
+
+// The AI's attack pick: two cells from its contested set.
+void BM_AttackMove(benchmark::State& state) {
+    const Board& board = position(state).board;
+    std::mt19937 rng(1);
+    int cells[3];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sampleCells(board.contested(CellState::AI), 2, cells, rng));
+    }
+}
+BENCHMARK(BM_AttackMove)->ArgsProduct({SIZES, DENSITIES});
+
+// The AI's speed pick: three cells from its frontier.
+void BM_SpeedMove(benchmark::State& state) {
+    const Board& board = position(state).board;
+    std::mt19937 rng(1);
+    int cells[3];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sampleCells(board.frontier(CellState::AI), 3, cells, rng));
+    }
+}
+BENCHMARK(BM_SpeedMove)->ArgsProduct({SIZES, DENSITIES});
+
+void BM_Result(benchmark::State& state) {
+    const GameState& game = position(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(result(game));
+    }
+}
+BENCHMARK(BM_Result)->ArgsProduct({SIZES, DENSITIES});
+
+// Gathering, scoring and picking from every candidate of one position; items
+// are candidates scored.
+void BM_GreedyMove(benchmark::State& state) {
+    const GameState& game = position(state);
+    EvalWeights weights;
+    CandidateBatch frontier;
+    CandidateBatch contested;
+    long long candidates = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(chooseGreedyMove(game, weights, frontier, contested));
+        candidates += frontier.size() + contested.size();
+    }
+    state.SetItemsProcessed(candidates);
+}
+BENCHMARK(BM_GreedyMove)->ArgsProduct({SIZES, DENSITIES});
+
+// Whole random-vs-random games; items are games.
+void BM_RandomGame(benchmark::State& state) {
+    Rules rules;
+    rules.gridSize = static_cast<int>(state.range(0));
+    RandomAgent player;
+    RandomAgent ai;
+    std::mt19937 rng(1);
+    GameState game;
+    MatchStats stats;
+    for (auto _ : state) {
+        playGame(game, rules, 4 * rules.gridSize * rules.gridSize, player, ai, rng, stats);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["turns/game"] = static_cast<double>(stats.turns) / std::max(1LL, stats.games);
+}
+BENCHMARK(BM_RandomGame)->ArgsProduct({SIZES})->Unit(benchmark::kMicrosecond);
+
+// A fixed number of MCTS iterations from an early or mid game position.
+void BM_MctsSearch(benchmark::State& state) {
+    const GameState& game = position(state);
+    MctsConfig config;
+    config.timeBudget = 1e9;
+    config.maxIterations = 2000;
+    std::mt19937 rng(1);
+    MctsStats total;
+    for (auto _ : state) {
+        MctsStats stats;
+        benchmark::DoNotOptimize(searchMcts(game, config, rng, &stats));
+        total.nodes += stats.nodes;
+        total.playouts += stats.playouts;
+    }
+    state.counters["nodes/s"] = benchmark::Counter(static_cast<double>(total.nodes), benchmark::Counter::kIsRate);
+    state.counters["playouts/s"] = benchmark::Counter(static_cast<double>(total.playouts), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MctsSearch)->ArgsProduct({SIZES, {10, 40}})->Unit(benchmark::kMillisecond);
+
+// The same iteration total split across root-parallel trees on a pool of
+// range(2) threads; wall time should fall close to 1/threads.
+void BM_MctsParallel(benchmark::State& state) {
+    const GameState& game = position(state);
+    ThreadPool pool(static_cast<int>(state.range(2)));
+    TranspositionTable table;
+    MctsConfig config;
+    config.timeBudget = 1e9;
+    config.maxIterations = 8000;
+    config.threads = static_cast<int>(state.range(2));
+    config.pool = &pool;
+    config.table = &table;
+    std::mt19937 rng(1);
+    for (auto _ : state) {
+        table.clear();
+        benchmark::DoNotOptimize(searchMcts(game, config, rng));
+    }
+}
+BENCHMARK(BM_MctsParallel)->ArgsProduct({{12}, {40}, {1, 2, 4, 8}})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,264 @@
+#include "bitboard.h"
+
+#include "random_ai.h"
+#include <algorithm>
+
+int sampleBits(const BitMask& mask, int wanted, int* out, std::mt19937& rng) {
+    int available = sampleRanks(mask.count(), wanted, out, rng);
+    for (int i = 0; i < available; i++) {
+        out[i] = mask.select(out[i]);
+    }
+    return available;
+}
+
+void BitMask::reset(int wordCount) {
+    words.assign(wordCount, 0);
+    blockCounts.assign((wordCount + BLOCK_WORDS - 1) / BLOCK_WORDS, 0);
+    total = 0;
+}
+
+void BitMask::rebuildCounts() {
+    total = 0;
+    for (size_t b = 0; b < blockCounts.size(); b++) {
+        size_t end = std::min(words.size(), (b + 1) * BLOCK_WORDS);
+        int sum = 0;
+        for (size_t w = b * BLOCK_WORDS; w < end; w++) sum += popcount64(words[w]);
+        blockCounts[b] = sum;
+        total += sum;
+    }
+}
+
+void BitMask::assignWord(int index, uint64_t value) {
+    uint64_t previous = words[index];
+    if (previous == value) return;
+    int delta = popcount64(value) - popcount64(previous);
+    words[index] = value;
+    blockCounts[index / BLOCK_WORDS] += delta;
+    total += delta;
+}
+
+int BitMask::select(int k) const {
+    int b = 0;
+    while (k >= blockCounts[b]) k -= blockCounts[b++];
+
+    int w = b * BLOCK_WORDS;
+    for (int bits = popcount64(words[w]); k >= bits; bits = popcount64(words[++w])) {
+        k -= bits;
+    }
+    uint64_t word = words[w];
+    for (; k > 0; k--) word &= word - 1;
+    return w * 64 + lowestBit(word);
+}
+
+void BitBoard::reset(int size) {
+    boardSize = size;
+    wordsPerRow = (size + 63) / 64;
+    for (int s = 0; s < 2; s++) {
+        planes[s].assign(size * wordsPerRow, 0);
+        frontierMasks[s].reset(size * wordsPerRow);
+        contestedMasks[s].reset(size * wordsPerRow);
+        ownedCounts[s] = 0;
+    }
+    cellHash = 0;
+    rowMask.assign(wordsPerRow, ~uint64_t(0));
+    if (size % 64 != 0) {
+        rowMask.back() = (uint64_t(1) << (size % 64)) - 1;
+    }
+}
+
+void BitBoard::load(const Board& board) {
+    if (board.size() != boardSize) {
+        reset(board.size());
+    } else {
+        for (std::vector<uint64_t>& plane : planes) {
+            std::fill(plane.begin(), plane.end(), 0);
+        }
+    }
+
+    const CellState* cells = board.data();
+    for (int y = 0; y < boardSize; y++) {
+        for (int x = 0; x < boardSize; x++) {
+            CellState state = cells[y * boardSize + x];
+            if (state == CellState::NEUTRAL) continue;
+            planes[side(state)][y * wordsPerRow + x / 64] |= uint64_t(1) << (x % 64);
+        }
+    }
+
+    for (int s = 0; s < 2; s++) {
+        CellState owner = s == 0 ? CellState::PLAYER : CellState::AI;
+        ownedCounts[s] = board.count(owner);
+        frontier(owner, frontierMasks[s].data());
+        contested(owner, contestedMasks[s].data());
+        frontierMasks[s].rebuildCounts();
+        contestedMasks[s].rebuildCounts();
+    }
+    cellHash = board.hash();
+}
+
+CellState BitBoard::at(int index) const {
+    int position = positionOf(index);
+    if (testPlane(0, position)) return CellState::PLAYER;
+    if (testPlane(1, position)) return CellState::AI;
+    return CellState::NEUTRAL;
+}
+
+void BitBoard::set(int index, CellState state) {
+    setPosition(positionOf(index), state);
+}
+
+void BitBoard::setPosition(int position, CellState state) {
+    int word = position >> 6;
+    uint64_t bit = uint64_t(1) << (position & 63);
+    CellState previous = (planes[0][word] & bit) ? CellState::PLAYER
+                       : (planes[1][word] & bit) ? CellState::AI : CellState::NEUTRAL;
+    if (previous == state) return;
+
+    int y = word / wordsPerRow;
+    int w = word % wordsPerRow;
+    int index = y * boardSize + w * 64 + (position & 63);
+    if (previous != CellState::NEUTRAL) {
+        planes[side(previous)][word] &= ~bit;
+        ownedCounts[side(previous)]--;
+        cellHash ^= zobristCell(index, side(previous));
+    }
+    if (state != CellState::NEUTRAL) {
+        planes[side(state)][word] |= bit;
+        ownedCounts[side(state)]++;
+        cellHash ^= zobristCell(index, side(state));
+    }
+
+    // only the words holding the cell and its four neighbours can change
+    refreshWord(y, w);
+    if (y > 0) refreshWord(y - 1, w);
+    if (y + 1 < boardSize) refreshWord(y + 1, w);
+    if ((position & 63) == 0 && w > 0) refreshWord(y, w - 1);
+    if ((position & 63) == 63 && w + 1 < wordsPerRow) refreshWord(y, w + 1);
+}
+
+uint64_t BitBoard::spread(const uint64_t* plane, int y, int w) const {
+    const uint64_t* row = plane + y * wordsPerRow;
+    uint64_t word = row[w];
+    uint64_t result = (word << 1) | (word >> 1);
+    if (w > 0) result |= row[w - 1] >> 63;
+    if (w + 1 < wordsPerRow) result |= row[w + 1] << 63;
+    if (y > 0) result |= row[w - wordsPerRow];
+    if (y + 1 < boardSize) result |= row[w + wordsPerRow];
+    return result & rowMask[w];
+}
+
+void BitBoard::refreshWord(int y, int w) {
+    int i = y * wordsPerRow + w;
+    uint64_t player = planes[0][i];
+    uint64_t ai = planes[1][i];
+    for (int s = 0; s < 2; s++) {
+        uint64_t reach = spread(planes[s].data(), y, w);
+        frontierMasks[s].assignWord(i, reach & ~(player | ai));
+        contestedMasks[s].assignWord(i, reach & (s == 0 ? ai : player));
+    }
+}
+
+template <typename Combine>
+void BitBoard::dilateInto(const std::vector<uint64_t>& source, uint64_t* out, Combine&& combine) const {
+    for (int y = 0; y < boardSize; y++) {
+        for (int w = 0; w < wordsPerRow; w++) {
+            int i = y * wordsPerRow + w;
+            out[i] = combine(spread(source.data(), y, w), i);
+        }
+    }
+}
+
+void BitBoard::frontier(CellState owner, uint64_t* out) const {
+    const uint64_t* player = planes[0].data();
+    const uint64_t* ai = planes[1].data();
+    dilateInto(planes[side(owner)], out,
+               [&](uint64_t spread, int i) { return spread & ~(player[i] | ai[i]); });
+}
+
+void BitBoard::contested(CellState attacker, uint64_t* out) const {
+    const uint64_t* opponent = planes[side(opponentOf(attacker))].data();
+    dilateInto(planes[side(attacker)], out,
+               [&](uint64_t spread, int i) { return spread & opponent[i]; });
+}
+
+void BitGame::load(const GameState& state) {
+    rules = state.rules;
+    board.load(state.board);
+    charges[0] = state.playerCharges;
+    charges[1] = state.aiCharges;
+    toMove = state.toMove;
+    outcome = state.outcome;
+    turn = state.turn;
+}
+
+uint64_t BitGame::hash() const {
+    uint64_t key = board.hash() ^ zobristCharges(0, charges[0]) ^ zobristCharges(1, charges[1]);
+    return toMove == CellState::AI ? key ^ zobristAiToMove() : key;
+}
+
+uint64_t BitGame::hashAfter(const Move& move) const {
+    return hashAfterMove(hash(), toMove, charges[toMove == CellState::PLAYER ? 0 : 1], rules.impulseCost, move);
+}
+
+int BitGame::sampleTargets(MoveType type, int wanted, int* out, std::mt19937& rng) const {
+    int picked = sampleBits(targets(type), wanted, out, rng);
+    for (int i = 0; i < picked; i++) out[i] = board.cellOf(out[i]);
+    return picked;
+}
+
+void BitGame::playRandomMove(std::mt19937& rng) {
+    if (isOver()) return;
+
+    CellState side = toMove;
+    int& sideCharges = charges[side == CellState::PLAYER ? 0 : 1];
+    bool canImpulse = sideCharges >= rules.impulseCost;
+    int cells[3];
+    int count;
+    bool impulse = true;
+
+    if (canImpulse && coinFlip(rng)) {
+        count = sampleBits(targets(MoveType::ATTACK), 2, cells, rng);
+    } else if (canImpulse && coinFlip(rng)) {
+        count = sampleBits(targets(MoveType::SPEED), 3, cells, rng);
+    } else {
+        count = sampleBits(targets(MoveType::CAPTURE), 1, cells, rng);
+        impulse = false;
+    }
+
+    // an impulse with no targets still costs the turn, as with chooseRandomMove
+    if (count > 0) {
+        for (int i = 0; i < count; i++) board.setPosition(cells[i], side);
+        sideCharges += impulse ? -rules.impulseCost : 1;
+    }
+    endTurn();
+}
+
+void BitGame::applyMove(const Move& move) {
+    if (isOver()) return;
+
+    CellState side = toMove;
+    int& sideCharges = charges[side == CellState::PLAYER ? 0 : 1];
+    for (int i = 0; i < move.count; i++) board.set(move.cells[i], side);
+    switch (move.type) {
+        case MoveType::CAPTURE: sideCharges++; break;
+        case MoveType::ATTACK:
+        case MoveType::SPEED: sideCharges -= rules.impulseCost; break;
+        case MoveType::PASS: break;
+    }
+    endTurn();
+}
+
+void BitGame::endTurn() {
+    CellState mover = toMove;
+    toMove = opponentOf(mover);
+    turn++;
+    if (mover != CellState::AI) return;
+
+    int playerCells = cells(CellState::PLAYER);
+    int aiCells = cells(CellState::AI);
+    outcome = resultFromCounts(playerCells, aiCells, rules.targetCells());
+    if (outcome == GameResult::NONE && board.frontierMask(CellState::PLAYER).empty() &&
+        board.frontierMask(CellState::AI).empty()) {
+        outcome = sealedResult(playerCells, aiCells, charges[0], charges[1], rules.impulseCost,
+                               !board.contestedMask(CellState::PLAYER).empty(), rules.targetCells());
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "rules.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline int popcount64(uint64_t word) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+inline int lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanForward64(&bit, word);
+    return static_cast<int>(bit);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Bit set over the padded bit positions of a BitBoard, with running counts per
+// block of words so the k-th set bit can be found without scanning every word.
+class BitMask {
+public:
+    void reset(int wordCount);
+    void rebuildCounts();
+
+    bool test(int bit) const { return (words[bit >> 6] >> (bit & 63)) & 1; }
+    void assignWord(int index, uint64_t value);
+
+    int count() const { return total; }
+    bool empty() const { return total == 0; }
+    // Position of the k-th set bit, 0 <= k < count().
+    int select(int k) const;
+
+    // Calls fn(position) for every set bit, in increasing position order.
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t w = 0; w < words.size(); w++) {
+            for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+                fn(static_cast<int>(w) * 64 + lowestBit(word));
+            }
+        }
+    }
+
+    uint64_t* data() { return words.data(); }
+    const uint64_t* data() const { return words.data(); }
+
+private:
+    static const int BLOCK_WORDS = 16;
+
+    std::vector<uint64_t> words;
+    std::vector<int> blockCounts;
+    int total = 0;
+};
+
+// Picks up to `wanted` (at most 3) distinct set bits of mask uniformly and
+// writes their positions to out; returns how many were picked.
+int sampleBits(const BitMask& mask, int wanted, int* out, std::mt19937& rng);
+
+// Board backend that keeps PLAYER and AI as bit planes, one bit per cell.
+// Each row is padded to whole 64-bit words, so cell (x, y) is bit position
+// y * rowWords() * 64 + x. NEUTRAL is whatever neither plane holds.
+//
+// frontierMask(side) and contestedMask(side) hold the same sets as Board's
+// frontier() and contested(). load() builds them for the whole board a word at
+// a time by dilating the side's plane (shifting it one cell each way, carrying
+// between words, padding masked off) and masking the result; set() redoes the
+// same shift-and-mask for just the words around the changed cell.
+class BitBoard {
+public:
+    BitBoard() = default;
+    explicit BitBoard(int size) { reset(size); }
+
+    void reset(int size);
+    void load(const Board& board);
+
+    int size() const { return boardSize; }
+    int rowWords() const { return wordsPerRow; }
+    int wordCount() const { return static_cast<int>(planes[0].size()); }
+
+    int positionOf(int index) const { return (index / boardSize) * wordsPerRow * 64 + index % boardSize; }
+    int cellOf(int position) const { return (position / 64 / wordsPerRow) * boardSize + position % (wordsPerRow * 64); }
+
+    CellState at(int index) const;
+    void set(int index, CellState state);
+    void setPosition(int position, CellState state);
+
+    int count(CellState owner) const { return ownedCounts[side(owner)]; }
+    // Same Zobrist key as Board::hash() for the same cells.
+    uint64_t hash() const { return cellHash; }
+    const uint64_t* plane(CellState owner) const { return planes[side(owner)].data(); }
+
+    const BitMask& frontierMask(CellState owner) const { return frontierMasks[side(owner)]; }
+    const BitMask& contestedMask(CellState attacker) const { return contestedMasks[side(attacker)]; }
+
+    // Word-parallel dilate(owner) & neutral into out (wordCount() words).
+    void frontier(CellState owner, uint64_t* out) const;
+    // Word-parallel dilate(attacker) & opponent into out (wordCount() words).
+    void contested(CellState attacker, uint64_t* out) const;
+
+private:
+    static int side(CellState owner) { return static_cast<int>(owner) - 1; }
+
+    bool testPlane(int s, int position) const { return (planes[s][position >> 6] >> (position & 63)) & 1; }
+    // Word w of row y of plane dilated by one cell, padding cleared.
+    uint64_t spread(const uint64_t* plane, int y, int w) const;
+    void refreshWord(int y, int w);
+
+    template <typename Combine>
+    void dilateInto(const std::vector<uint64_t>& source, uint64_t* out, Combine&& combine) const;
+
+    int boardSize = 0;
+    int wordsPerRow = 0;
+    std::vector<uint64_t> planes[2];
+    std::vector<uint64_t> rowMask;  // valid bits of each word in a row
+    BitMask frontierMasks[2];
+    BitMask contestedMasks[2];
+    int ownedCounts[2] = {0, 0};
+    uint64_t cellHash = 0;
+};
+
+// Search-only game state on a BitBoard: the same rules as GameState, but a
+// fraction of the size to copy, which is what tree search does every
+// iteration. Moves are not validated; they must come from this state's masks.
+struct BitGame {
+    Rules rules;
+    BitBoard board;
+    int charges[2] = {0, 0};
+    CellState toMove = CellState::PLAYER;
+    GameResult outcome = GameResult::NONE;
+    int turn = 0;
+
+    void load(const GameState& state);
+
+    int cells(CellState owner) const { return board.count(owner); }
+    bool canUseImpulse(CellState side) const { return charges[side == CellState::PLAYER ? 0 : 1] >= rules.impulseCost; }
+    bool isOver() const { return outcome != GameResult::NONE; }
+    // Same key as GameState::hash() for the same position.
+    uint64_t hash() const;
+    // hash() of the position after move, without playing it.
+    uint64_t hashAfter(const Move& move) const;
+
+    // Cells toMove may pick for a move of the given type: the frontier for
+    // captures and speed impulses, enemy cells in reach for attacks.
+    const BitMask& targets(MoveType type) const {
+        return type == MoveType::ATTACK ? board.contestedMask(toMove) : board.frontierMask(toMove);
+    }
+    int targetCount(MoveType type) const { return targets(type).count(); }
+
+    template <typename Fn>
+    void forEachTarget(MoveType type, Fn&& fn) const {
+        targets(type).forEach([&](int position) { fn(board.cellOf(position)); });
+    }
+
+    // Up to `wanted` distinct targets, drawn uniformly, as board indices.
+    int sampleTargets(MoveType type, int wanted, int* out, std::mt19937& rng) const;
+
+    void applyMove(const Move& move);
+
+    // One move of the chooseRandomMove policy for toMove: the same coin flips
+    // for attack and speed and the same uniform picks, drawn from bit masks.
+    void playRandomMove(std::mt19937& rng);
+
+private:
+    void endTurn();
+};
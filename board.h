@@ -0,0 +1,238 @@
+#pragma once
+
+#include "zobrist.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+enum class CellState : uint8_t { NEUTRAL, PLAYER, AI };
+
+inline CellState opponentOf(CellState side) {
+    return side == CellState::PLAYER ? CellState::AI : CellState::PLAYER;
+}
+
+struct NeighborOffset {
+    int dx;
+    int dy;
+};
+
+// Orthogonal neighbours, in the same order the original getAdjacentCells used.
+constexpr NeighborOffset NEIGHBOR_OFFSETS[4] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+// Unordered set of cell indices with O(1) insert, erase and membership.
+// Items are kept densely packed so iteration costs only the set size.
+class CellSet {
+public:
+    void reset(int cellCount) {
+        items.clear();
+        items.reserve(cellCount);
+        slots.assign(cellCount, -1);
+    }
+
+    bool contains(int cell) const { return slots[cell] >= 0; }
+
+    void insert(int cell) {
+        if (slots[cell] >= 0) return;
+        slots[cell] = static_cast<int>(items.size());
+        items.push_back(cell);
+    }
+
+    void erase(int cell) {
+        int slot = slots[cell];
+        if (slot < 0) return;
+        int last = items.back();
+        items[slot] = last;
+        slots[last] = slot;
+        items.pop_back();
+        slots[cell] = -1;
+    }
+
+    int size() const { return static_cast<int>(items.size()); }
+    bool empty() const { return items.empty(); }
+    int operator[](int i) const { return items[i]; }
+
+    std::vector<int>::const_iterator begin() const { return items.begin(); }
+    std::vector<int>::const_iterator end() const { return items.end(); }
+
+private:
+    std::vector<int> items;
+    std::vector<int> slots;
+};
+
+// One bit per cell index, for membership tests that are cheaper to clear and
+// compare than a CellSet when the set is small or only ever tested.
+class CellMask {
+public:
+    void reset(int cellCount) { words.assign((cellCount + 63) / 64, 0); }
+    void clear() { std::fill(words.begin(), words.end(), 0); }
+
+    bool test(int cell) const { return (words[cell >> 6] >> (cell & 63)) & 1; }
+    void set(int cell) { words[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    void unset(int cell) { words[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+
+    int wordCount() const { return static_cast<int>(words.size()); }
+    uint64_t word(int i) const { return words[i]; }
+
+    bool operator==(const CellMask& other) const { return words == other.words; }
+    bool operator!=(const CellMask& other) const { return words != other.words; }
+
+private:
+    std::vector<uint64_t> words;
+};
+
+// Square board stored as one contiguous row-major buffer, one byte per cell.
+// Cell (x, y) lives at index y * size + x.
+//
+// Besides the cells the board tracks, per side, how many of each cell's
+// neighbours it owns, and from that two sets that are patched on every set():
+//   frontier(side)  - neutral cells adjacent to side (legal captures)
+//   contested(side) - opponent cells adjacent to side (legal attack targets)
+class Board {
+public:
+    Board() = default;
+    explicit Board(int size) { reset(size); }
+
+    void reset(int size) {
+        boardSize = size;
+        cells.assign(size * size, CellState::NEUTRAL);
+        changes++;
+        recentChanges[changes % CHANGE_HISTORY] = -1;
+        cellHash = 0;
+        for (int s = 0; s < 2; s++) {
+            neighborCounts[s].assign(size * size, 0);
+            frontierSets[s].reset(size * size);
+            contestedSets[s].reset(size * size);
+            ownedCounts[s] = 0;
+        }
+    }
+
+    int size() const { return boardSize; }
+    int cellCount() const { return static_cast<int>(cells.size()); }
+
+    int index(int x, int y) const { return y * boardSize + x; }
+    int xOf(int index) const { return index % boardSize; }
+    int yOf(int index) const { return index / boardSize; }
+
+    bool inBounds(int x, int y) const {
+        return x >= 0 && x < boardSize && y >= 0 && y < boardSize;
+    }
+
+    CellState at(int x, int y) const { return cells[index(x, y)]; }
+    CellState at(int index) const { return cells[index]; }
+
+    // Calls fn(nx, ny) for every in-bounds orthogonal neighbour of (x, y).
+    template <typename Fn>
+    void forEachNeighbor(int x, int y, Fn&& fn) const {
+        for (const NeighborOffset& offset : NEIGHBOR_OFFSETS) {
+            int nx = x + offset.dx;
+            int ny = y + offset.dy;
+            if (inBounds(nx, ny)) fn(nx, ny);
+        }
+    }
+
+    // Calls fn(neighborIndex) for every in-bounds orthogonal neighbour of index.
+    template <typename Fn>
+    void forEachNeighbor(int index, Fn&& fn) const {
+        int x = xOf(index);
+        int y = yOf(index);
+        for (const NeighborOffset& offset : NEIGHBOR_OFFSETS) {
+            int nx = x + offset.dx;
+            int ny = y + offset.dy;
+            if (inBounds(nx, ny)) fn(index + offset.dy * boardSize + offset.dx);
+        }
+    }
+
+    // True if any in-bounds neighbour of index satisfies pred(neighborIndex).
+    template <typename Pred>
+    bool anyNeighbor(int index, Pred&& pred) const {
+        int x = xOf(index);
+        int y = yOf(index);
+        for (const NeighborOffset& offset : NEIGHBOR_OFFSETS) {
+            int nx = x + offset.dx;
+            int ny = y + offset.dy;
+            if (inBounds(nx, ny) && pred(index + offset.dy * boardSize + offset.dx)) return true;
+        }
+        return false;
+    }
+
+    void set(int x, int y, CellState state) { set(index(x, y), state); }
+
+    void set(int index, CellState state) {
+        CellState previous = cells[index];
+        if (previous == state) return;
+        cells[index] = state;
+        changes++;
+        recentChanges[changes % CHANGE_HISTORY] = index;
+
+        if (previous != CellState::NEUTRAL) {
+            ownedCounts[side(previous)]--;
+            cellHash ^= zobristCell(index, side(previous));
+        }
+        if (state != CellState::NEUTRAL) {
+            ownedCounts[side(state)]++;
+            cellHash ^= zobristCell(index, side(state));
+        }
+
+        forEachNeighbor(index, [&](int neighbor) { updateNeighbor(neighbor, previous, state); });
+        refresh(index);
+    }
+
+    int count(CellState owner) const { return ownedCounts[side(owner)]; }
+    int adjacentCount(int index, CellState owner) const { return neighborCounts[side(owner)][index]; }
+
+    const CellSet& frontier(CellState owner) const { return frontierSets[side(owner)]; }
+    const CellSet& contested(CellState attacker) const { return contestedSets[side(attacker)]; }
+
+    const CellState* data() const { return cells.data(); }
+
+    // Zobrist key of the cells alone, kept up to date by set().
+    uint64_t hash() const { return cellHash; }
+
+    // Bumped on every reset() and every effective set(), so observers such
+    // as renderers can skip work while the board is unchanged.
+    uint32_t revision() const { return changes; }
+
+    static const int CHANGE_HISTORY = 32;
+
+    // The cell whose set() made revision r, so an observer a few revisions
+    // behind can catch up on just those cells. False if r is more than
+    // CHANGE_HISTORY revisions old or was made by reset(): start over then.
+    bool changeAt(uint32_t r, int& cell) const {
+        if (r > changes || changes - r >= CHANGE_HISTORY || recentChanges[r % CHANGE_HISTORY] < 0) return false;
+        cell = recentChanges[r % CHANGE_HISTORY];
+        return true;
+    }
+
+private:
+    static int side(CellState owner) { return static_cast<int>(owner) - 1; }
+
+    void updateNeighbor(int neighbor, CellState previous, CellState state) {
+        if (previous != CellState::NEUTRAL) neighborCounts[side(previous)][neighbor]--;
+        if (state != CellState::NEUTRAL) neighborCounts[side(state)][neighbor]++;
+        refresh(neighbor);
+    }
+
+    void refresh(int index) {
+        CellState state = cells[index];
+        for (int s = 0; s < 2; s++) {
+            bool touched = neighborCounts[s][index] > 0;
+            CellState opponent = s == 0 ? CellState::AI : CellState::PLAYER;
+
+            if (touched && state == CellState::NEUTRAL) frontierSets[s].insert(index);
+            else frontierSets[s].erase(index);
+
+            if (touched && state == opponent) contestedSets[s].insert(index);
+            else contestedSets[s].erase(index);
+        }
+    }
+
+    int boardSize = 0;
+    std::vector<CellState> cells;
+    std::vector<uint8_t> neighborCounts[2];
+    CellSet frontierSets[2];
+    CellSet contestedSets[2];
+    int ownedCounts[2] = {0, 0};
+    uint32_t changes = 0;
+    int recentChanges[CHANGE_HISTORY] = {};
+    uint64_t cellHash = 0;
+};
@@ -0,0 +1,209 @@
+#include "board_renderer.h"
+
+#include "bitboard.h"
+#include "rlgl.h"
+#include <algorithm>
+
+namespace {
+
+const int UPLOAD_BAND = 32;  // rows merged into one sub-rectangle upload
+
+// raylib's default vertex shader feeds this fragTexCoord across the quad.
+// Colours and proportions follow the cached renderer: white 1-unit grid
+// lines around each cell's fill, a yellow ring two units in for a
+// legal capture (a yellow wash once cells are too small), and selected
+// cells at 30% of their colour.
+const char* BOARD_FRAGMENT_SHADER = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec2 gridSize;
+uniform float cellSize;
+uniform float dimmed;
+uniform float showMoves;
+out vec4 finalColor;
+
+void main() {
+    vec2 position = fragTexCoord * gridSize;
+    vec4 cell = texelFetch(texture0, ivec2(min(position, gridSize - 1.0)), 0);
+    vec2 unit = fract(position) * cellSize;
+
+    int owner = int(cell.r * 255.0 + 0.5);
+    vec3 fill = owner == 1 ? vec3(0.0, 0.475, 0.945) : owner == 2 ? vec3(0.902, 0.161, 0.216)
+                                                                  : vec3(0.51, 0.51, 0.51);
+    if (cell.b > 0.5) {
+        if (owner != 0) fill *= 0.3;
+    } else if (dimmed > 0.5) {
+        fill *= 0.498;
+    }
+
+    vec3 color = fill;
+    if (cellSize > 2.0) {
+        if (unit.x < 1.0 || unit.y < 1.0 || unit.x >= cellSize - 1.0 || unit.y >= cellSize - 1.0) color = vec3(1.0);
+    }
+    if (showMoves > 0.5 && cell.g > 0.5) {
+        vec3 yellow = vec3(0.992, 0.976, 0.0);
+        if (cellSize > 4.0) {
+            bool inside = unit.x >= 2.0 && unit.y >= 2.0 && unit.x < cellSize - 2.0 && unit.y < cellSize - 2.0;
+            bool edge = unit.x < 3.0 || unit.y < 3.0 || unit.x >= cellSize - 3.0 || unit.y >= cellSize - 3.0;
+            if (inside && edge) color = yellow;
+        } else {
+            color = mix(color, yellow, 0.6);
+        }
+    }
+    finalColor = vec4(color, 1.0);
+}
+)";
+
+Color texelFor(const Board& board, int index, bool selected) {
+    CellState state = board.at(index);
+    bool frontier = board.frontier(CellState::PLAYER).contains(index);
+    return Color{static_cast<unsigned char>(state), static_cast<unsigned char>(frontier ? 255 : 0),
+                 static_cast<unsigned char>(selected ? 255 : 0), 255};
+}
+
+bool sameTexel(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+}
+
+bool BoardRenderer::load(int gridSize) {
+    unload();
+    shader = LoadShaderFromMemory(nullptr, BOARD_FRAGMENT_SHADER);
+    if (shader.id == 0 || shader.id == rlGetShaderIdDefault()) {
+        return false;
+    }
+    gridSizeLoc = GetShaderLocation(shader, "gridSize");
+    cellSizeLoc = GetShaderLocation(shader, "cellSize");
+    dimmedLoc = GetShaderLocation(shader, "dimmed");
+    showMovesLoc = GetShaderLocation(shader, "showMoves");
+
+    size = gridSize;
+    texels.assign(static_cast<size_t>(size) * size, Color{0, 0, 0, 255});
+    Image image = {texels.data(), size, size, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    texture = LoadTextureFromImage(image);
+    SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+
+    dirtyFirst.assign(size, size);
+    dirtyLast.assign(size, -1);
+    selected.reset(size * size);
+    current = false;
+    ready = true;
+    return true;
+}
+
+void BoardRenderer::unload() {
+    if (!ready) {
+        return;
+    }
+    UnloadTexture(texture);
+    UnloadShader(shader);
+    texels.clear();
+    staging.clear();
+    ready = false;
+}
+
+void BoardRenderer::update(const Board& board, const CellMask& selection) {
+    if (!ready || board.size() != size || selection.wordCount() != selected.wordCount()) {
+        return;
+    }
+    bool selectionChanged = selection != selected;
+    if (current && revision == board.revision() && !selectionChanged) {
+        return;
+    }
+
+    // a move changes its own cells and, through the frontier, their
+    // neighbours; only a new game, or falling far behind, repaints it all
+    bool caughtUp = current && board.revision() >= revision;
+    for (uint32_t r = revision + 1; caughtUp && r <= board.revision(); r++) {
+        int cell;
+        caughtUp = board.changeAt(r, cell);
+    }
+    if (!caughtUp) {
+        for (int index = 0; index < size * size; index++) retexel(board, index, selection);
+    } else {
+        for (uint32_t r = revision + 1; r <= board.revision(); r++) {
+            int cell;
+            board.changeAt(r, cell);
+            retexel(board, cell, selection);
+            board.forEachNeighbor(cell, [&](int neighbor) { retexel(board, neighbor, selection); });
+        }
+        for (int w = 0; w < selection.wordCount(); w++) {
+            for (uint64_t bits = selection.word(w) ^ selected.word(w); bits != 0; bits &= bits - 1) {
+                retexel(board, w * 64 + lowestBit(bits), selection);
+            }
+        }
+    }
+    selected = selection;
+    revision = board.revision();
+    current = true;
+    upload();
+}
+
+void BoardRenderer::retexel(const Board& board, int index, const CellMask& selection) {
+    Color texel = texelFor(board, index, selection.test(index));
+    if (!sameTexel(texel, texels[index])) {
+        texels[index] = texel;
+        markRow(board.yOf(index), board.xOf(index));
+    }
+}
+
+void BoardRenderer::markRow(int y, int x) {
+    dirtyFirst[y] = std::min(dirtyFirst[y], x);
+    dirtyLast[y] = std::max(dirtyLast[y], x);
+}
+
+void BoardRenderer::upload() {
+    for (int band = 0; band < size; band += UPLOAD_BAND) {
+        int bandEnd = std::min(size, band + UPLOAD_BAND);
+        int firstX = size;
+        int lastX = -1;
+        int firstY = bandEnd;
+        int lastY = band - 1;
+        for (int y = band; y < bandEnd; y++) {
+            if (dirtyFirst[y] > dirtyLast[y]) {
+                continue;
+            }
+            firstX = std::min(firstX, dirtyFirst[y]);
+            lastX = std::max(lastX, dirtyLast[y]);
+            firstY = std::min(firstY, y);
+            lastY = y;
+            dirtyFirst[y] = size;
+            dirtyLast[y] = -1;
+        }
+        if (lastX < firstX) {
+            continue;
+        }
+
+        int width = lastX - firstX + 1;
+        int height = lastY - firstY + 1;
+        staging.resize(static_cast<size_t>(width) * height);
+        for (int y = 0; y < height; y++) {
+            const Color* row = texels.data() + static_cast<size_t>(firstY + y) * size + firstX;
+            std::copy(row, row + width, staging.begin() + static_cast<size_t>(y) * width);
+        }
+        UpdateTextureRec(texture, Rectangle{(float)firstX, (float)firstY, (float)width, (float)height},
+                         staging.data());
+    }
+}
+
+void BoardRenderer::draw(int cellSize, bool dimmed, bool showMoves) const {
+    if (!ready) {
+        return;
+    }
+    float grid[2] = {(float)size, (float)size};
+    float cell = (float)cellSize;
+    float dim = dimmed ? 1.0f : 0.0f;
+    float moves = showMoves ? 1.0f : 0.0f;
+    SetShaderValue(shader, gridSizeLoc, grid, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, cellSizeLoc, &cell, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, dimmedLoc, &dim, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, showMovesLoc, &moves, SHADER_UNIFORM_FLOAT);
+
+    float world = (float)size * cellSize;
+    BeginShaderMode(shader);
+    DrawTexturePro(texture, Rectangle{0, 0, (float)size, (float)size}, Rectangle{0, 0, world, world},
+                   Vector2{0, 0}, 0.0f, WHITE);
+    EndShaderMode();
+}
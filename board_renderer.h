@@ -0,0 +1,59 @@
+#pragma once
+
+#include "board.h"
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+
+// Draws the whole board in one fragment shader pass over a single quad. The
+// board lives in a texture with one texel per cell: red holds the owner,
+// green marks the player's frontier and blue the impulse selection. The
+// shader derives fills, grid lines, move highlights and selection from that,
+// so drawing costs the same at 7x7 and at 1024x1024. update() recomputes only
+// the cells a move touched and their neighbours, from the board's change
+// history, and re-uploads only the rows that changed, a band at a time.
+class BoardRenderer {
+public:
+    BoardRenderer() = default;
+    BoardRenderer(const BoardRenderer&) = delete;
+    BoardRenderer& operator=(const BoardRenderer&) = delete;
+    ~BoardRenderer() { unload(); }
+
+    // False, with nothing loaded, if the GPU cannot compile the shader; the
+    // caller then keeps its own renderer.
+    bool load(int gridSize);
+    void unload();
+    bool loaded() const { return ready; }
+
+    // Brings the texture up to date with board and the selected cells.
+    // Cheap when neither changed since the last call; a selection change
+    // alone touches only the cells that joined or left it.
+    void update(const Board& board, const CellMask& selection);
+
+    // Draws the board at world (0, 0), cellSize world units per cell; call
+    // inside BeginMode2D. dimmed darkens unselected cells as impulse
+    // selection does and showMoves outlines the player's frontier.
+    void draw(int cellSize, bool dimmed, bool showMoves) const;
+
+private:
+    void retexel(const Board& board, int index, const CellMask& selection);
+    void markRow(int y, int x);
+    void upload();
+
+    bool ready = false;
+    int size = 0;
+    Texture2D texture = {};
+    Shader shader = {};
+    int gridSizeLoc = -1;
+    int cellSizeLoc = -1;
+    int dimmedLoc = -1;
+    int showMovesLoc = -1;
+
+    uint32_t revision = 0;
+    bool current = false;
+    std::vector<Color> texels;
+    std::vector<Color> staging;
+    CellMask selected;
+    std::vector<int> dirtyFirst;  // per row, first and last changed column; first > last when clean
+    std::vector<int> dirtyLast;
+};
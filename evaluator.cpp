@@ -0,0 +1,56 @@
+#include "evaluator.h"
+
+void CandidateBatch::grow() {
+    capacity = capacity == 0 ? 64 : capacity * 2;
+    cells.resize(static_cast<size_t>(capacity));
+    open.resize(static_cast<size_t>(capacity));
+    support.resize(static_cast<size_t>(capacity));
+    exposure.resize(static_cast<size_t>(capacity));
+    proximity.resize(static_cast<size_t>(capacity));
+    swing.resize(static_cast<size_t>(capacity));
+    scores.resize(static_cast<size_t>(capacity));
+}
+
+void CandidateBatch::add(int cell, float openCount, float supportCount, float exposureCount,
+                         float proximityValue, float swingValue) {
+    if (count == capacity) grow();
+    cells[count] = cell;
+    open[count] = openCount;
+    support[count] = supportCount;
+    exposure[count] = exposureCount;
+    proximity[count] = proximityValue;
+    swing[count] = swingValue;
+    count++;
+}
+
+void CandidateBatch::score(const EvalWeights& weights) {
+    // whole lanes only: capacity is a multiple of LANES and the slots past
+    // count hold stale but finite features, so no remainder loop is needed
+    int padded = (count + LANES - 1) / LANES * LANES;
+    const float* __restrict openIn = open.data();
+    const float* __restrict supportIn = support.data();
+    const float* __restrict exposureIn = exposure.data();
+    const float* __restrict proximityIn = proximity.data();
+    const float* __restrict swingIn = swing.data();
+    float* __restrict out = scores.data();
+    for (int lane = 0; lane < padded; lane += LANES) {
+        for (int i = lane; i < lane + LANES; i++) {
+            out[i] = weights.open * openIn[i] + weights.support * supportIn[i] +
+                     weights.exposure * exposureIn[i] + weights.proximity * proximityIn[i] +
+                     weights.swing * swingIn[i];
+        }
+    }
+}
+
+int CandidateBatch::best(int wanted, int* out) const {
+    int picked = 0;
+    for (int i = 0; i < count; i++) {
+        int slot = picked;
+        while (slot > 0 && scores[out[slot - 1]] < scores[i]) slot--;
+        if (slot >= wanted) continue;
+        if (picked < wanted) picked++;
+        for (int j = picked - 1; j > slot; j--) out[j] = out[j - 1];
+        out[slot] = i;
+    }
+    return picked;
+}
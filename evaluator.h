@@ -0,0 +1,155 @@
+#pragma once
+
+#include "rules.h"
+#include <cstdlib>
+#include <vector>
+
+// How much each feature of a target cell is worth to the side taking it.
+struct EvalWeights {
+    float open = 1.0f;        // neutral neighbours: room the capture opens up
+    float support = 0.4f;     // own neighbours: cells that keep it connected
+    float exposure = -0.5f;   // opponent neighbours: how easily it is attacked back
+    float proximity = 0.8f;   // 1 next to the opponent, falling to 0 PROXIMITY_RADIUS away
+    float swing = 2.0f;       // 1 for an opponent cell, which the opponent also loses
+    float tempo = 0.75f;      // the charge a capture earns and an impulse spends
+};
+
+const int PROXIMITY_RADIUS = 3;
+
+// Candidate target cells and their features as structure of arrays, so
+// score() runs one multiply-add pass per feature over the whole batch. The
+// arrays are allocated in whole lanes and score() fills the slots past
+// size() as well, which keeps the loop free of a remainder; best() never
+// reads them.
+class CandidateBatch {
+public:
+    static const int LANES = 8;
+
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void add(int cell, float open, float support, float exposure, float proximity, float swing);
+
+    // scores[i] = the weighted sum of candidate i's features, for every i at once.
+    void score(const EvalWeights& weights);
+
+    int cell(int i) const { return cells[i]; }
+    float scoreOf(int i) const { return scores[i]; }
+
+    // Writes the indices of the `wanted` (at most 3) best scored candidates,
+    // best first, and returns how many there were. Ties go to the earlier one.
+    int best(int wanted, int* out) const;
+
+private:
+    void grow();
+
+    int count = 0;
+    int capacity = 0;
+    std::vector<int> cells;
+    std::vector<float> open;
+    std::vector<float> support;
+    std::vector<float> exposure;
+    std::vector<float> proximity;
+    std::vector<float> swing;
+    std::vector<float> scores;
+};
+
+// 1 if an opponent cell is orthogonally adjacent to cell, falling linearly to
+// 0 when the nearest is further than PROXIMITY_RADIUS steps away. Board is
+// anything with size() and at(index): Board, BitBoard or FixedBoard<N>.
+template <typename AnyBoard>
+float opponentProximity(const AnyBoard& board, int cell, CellState opponent) {
+    int size = board.size();
+    int x = cell % size;
+    int y = cell / size;
+    for (int radius = 1; radius <= PROXIMITY_RADIUS; radius++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            int dy = radius - std::abs(dx);
+            int nx = x + dx;
+            if (nx < 0 || nx >= size) continue;
+            if (y + dy < size && board.at((y + dy) * size + nx) == opponent) {
+                return 1.0f - static_cast<float>(radius - 1) / PROXIMITY_RADIUS;
+            }
+            if (dy != 0 && y - dy >= 0 && board.at((y - dy) * size + nx) == opponent) {
+                return 1.0f - static_cast<float>(radius - 1) / PROXIMITY_RADIUS;
+            }
+        }
+    }
+    return 0.0f;
+}
+
+// Reads cell's neighbourhood on board and appends it to batch as a target
+// for side: a capture or speed target if it is neutral, an attack target if
+// the opponent holds it.
+template <typename AnyBoard>
+void addCandidate(const AnyBoard& board, CellState side, int cell, CandidateBatch& batch) {
+    int size = board.size();
+    int x = cell % size;
+    int y = cell / size;
+    CellState opponent = opponentOf(side);
+    int counts[3] = {0, 0, 0};
+    for (const NeighborOffset& offset : NEIGHBOR_OFFSETS) {
+        int nx = x + offset.dx;
+        int ny = y + offset.dy;
+        if (nx >= 0 && nx < size && ny >= 0 && ny < size) {
+            counts[static_cast<int>(board.at(ny * size + nx))]++;
+        }
+    }
+    int exposure = counts[static_cast<int>(opponent)];
+    float proximity = exposure > 0 ? 1.0f : opponentProximity(board, cell, opponent);
+    bool taken = board.at(cell) == opponent;
+    batch.add(cell, static_cast<float>(counts[static_cast<int>(CellState::NEUTRAL)]),
+              static_cast<float>(counts[static_cast<int>(side)]), static_cast<float>(exposure),
+              proximity, taken ? 1.0f : 0.0f);
+}
+
+// The greedy policy: scores every frontier and contested cell of side in one
+// batch each and plays whichever is worth most of the best capture plus a
+// charge, the best three frontier cells as a speed impulse, or the best two
+// opponent cells as an attack. forEachTarget(type, fn) calls fn(cell) for
+// every target of the move type, as BitGame and FixedGame do.
+template <typename AnyBoard, typename ForEachTarget>
+Move chooseScoredMove(const AnyBoard& board, CellState side, bool canImpulse, ForEachTarget&& forEachTarget,
+                      const EvalWeights& weights, CandidateBatch& frontier, CandidateBatch& contested) {
+    frontier.clear();
+    forEachTarget(MoveType::CAPTURE, [&](int cell) { addCandidate(board, side, cell, frontier); });
+    if (frontier.empty() && !canImpulse) return Move::pass();
+
+    int top[3];
+    int found = 0;
+    Move move;
+    float bestValue = 0.0f;
+    if (!frontier.empty()) {
+        frontier.score(weights);
+        found = frontier.best(canImpulse ? 3 : 1, top);
+        move = Move::capture(frontier.cell(top[0]));
+        bestValue = frontier.scoreOf(top[0]) + weights.tempo;
+    }
+    if (!canImpulse) return move;
+
+    if (found == 3) {
+        float speed = frontier.scoreOf(top[0]) + frontier.scoreOf(top[1]) + frontier.scoreOf(top[2]);
+        if (speed > bestValue) {
+            bestValue = speed;
+            move.type = MoveType::SPEED;
+            move.count = 3;
+            for (int i = 0; i < 3; i++) move.cells[i] = frontier.cell(top[i]);
+        }
+    }
+
+    contested.clear();
+    forEachTarget(MoveType::ATTACK, [&](int cell) { addCandidate(board, side, cell, contested); });
+    if (!contested.empty()) {
+        contested.score(weights);
+        int taken = contested.best(2, top);
+        float attack = 0.0f;
+        for (int i = 0; i < taken; i++) attack += contested.scoreOf(top[i]);
+        if (move.type == MoveType::PASS || attack > bestValue) {
+            move.type = MoveType::ATTACK;
+            move.count = static_cast<uint8_t>(taken);
+            for (int i = 0; i < taken; i++) move.cells[i] = contested.cell(top[i]);
+        }
+    }
+    return move;
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "bitboard.h"
+#include "random_ai.h"
+#include <array>
+
+// Every cell of an N x N board except those in skippedColumn.
+template <int N>
+constexpr std::array<uint64_t, (N * N + 63) / 64> fixedColumnMask(int skippedColumn) {
+    std::array<uint64_t, (N * N + 63) / 64> mask{};
+    for (int i = 0; i < N * N; i++) {
+        if (i % N != skippedColumn) mask[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+    return mask;
+}
+
+// Bit-plane board for a size fixed at compile time, for the standard menu
+// sizes. Cells are packed row-major with no padding, so cell index and bit
+// position coincide, and the word count, shifts and column masks are all
+// constants: dilating a plane is a handful of unrolled word operations.
+template <int N>
+class FixedBoard {
+public:
+    static_assert(N >= 2 && N < 64, "rows are shifted within 64-bit words");
+
+    static constexpr int CELLS = N * N;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+    using Mask = std::array<uint64_t, WORDS>;
+
+    void load(const Board& board) {
+        planes[0] = Mask{};
+        planes[1] = Mask{};
+        const CellState* cells = board.data();
+        for (int i = 0; i < CELLS; i++) {
+            if (cells[i] != CellState::NEUTRAL) planes[side(cells[i])][i >> 6] |= uint64_t(1) << (i & 63);
+        }
+        cellHash = board.hash();
+    }
+
+    static constexpr int size() { return N; }
+
+    CellState at(int index) const {
+        if (testBit(planes[0], index)) return CellState::PLAYER;
+        if (testBit(planes[1], index)) return CellState::AI;
+        return CellState::NEUTRAL;
+    }
+
+    void set(int index, CellState state) {
+        CellState previous = at(index);
+        if (previous == state) return;
+        uint64_t bit = uint64_t(1) << (index & 63);
+        if (previous != CellState::NEUTRAL) {
+            planes[side(previous)][index >> 6] &= ~bit;
+            cellHash ^= zobristCell(index, side(previous));
+        }
+        if (state != CellState::NEUTRAL) {
+            planes[side(state)][index >> 6] |= bit;
+            cellHash ^= zobristCell(index, side(state));
+        }
+    }
+
+    int count(CellState owner) const { return countBits(planes[side(owner)]); }
+    uint64_t hash() const { return cellHash; }
+
+    Mask frontier(CellState owner) const {
+        Mask reach = dilate(planes[side(owner)]);
+        for (int w = 0; w < WORDS; w++) reach[w] &= ~(planes[0][w] | planes[1][w]);
+        return reach;
+    }
+
+    Mask contested(CellState attacker) const {
+        Mask reach = dilate(planes[side(attacker)]);
+        const Mask& opponent = planes[side(opponentOf(attacker))];
+        for (int w = 0; w < WORDS; w++) reach[w] &= opponent[w];
+        return reach;
+    }
+
+    static bool testBit(const Mask& mask, int bit) { return (mask[bit >> 6] >> (bit & 63)) & 1; }
+
+    static bool any(const Mask& mask) {
+        uint64_t bits = 0;
+        for (int w = 0; w < WORDS; w++) bits |= mask[w];
+        return bits != 0;
+    }
+
+    static int countBits(const Mask& mask) {
+        int total = 0;
+        for (int w = 0; w < WORDS; w++) total += popcount64(mask[w]);
+        return total;
+    }
+
+    // Index of the k-th set bit of mask, 0 <= k < countBits(mask).
+    static int select(const Mask& mask, int k) {
+        int w = 0;
+        for (; w < WORDS - 1; w++) {
+            int bits = popcount64(mask[w]);
+            if (k < bits) break;
+            k -= bits;
+        }
+        uint64_t word = mask[w];
+        for (; k > 0; k--) word &= word - 1;
+        return w * 64 + lowestBit(word);
+    }
+
+private:
+    static int side(CellState owner) { return static_cast<int>(owner) - 1; }
+
+    // Not column 0 after a shift towards higher indices, not column N-1 after
+    // a shift towards lower ones: the bits that wrapped between rows. Both
+    // also clear the padding past the last cell.
+    static constexpr Mask NOT_FIRST_COLUMN = fixedColumnMask<N>(0);
+    static constexpr Mask NOT_LAST_COLUMN = fixedColumnMask<N>(N - 1);
+    static constexpr Mask ALL_CELLS = fixedColumnMask<N>(-1);
+
+    template <int K>
+    static Mask shiftUp(const Mask& mask) {
+        Mask out;
+        for (int w = 0; w < WORDS; w++) {
+            out[w] = (mask[w] << K) | (w > 0 ? mask[w - 1] >> (64 - K) : 0);
+        }
+        return out;
+    }
+
+    template <int K>
+    static Mask shiftDown(const Mask& mask) {
+        Mask out;
+        for (int w = 0; w < WORDS; w++) {
+            out[w] = (mask[w] >> K) | (w + 1 < WORDS ? mask[w + 1] << (64 - K) : 0);
+        }
+        return out;
+    }
+
+    static Mask dilate(const Mask& plane) {
+        Mask right = shiftUp<1>(plane);
+        Mask left = shiftDown<1>(plane);
+        Mask below = shiftUp<N>(plane);
+        Mask above = shiftDown<N>(plane);
+        Mask out;
+        for (int w = 0; w < WORDS; w++) {
+            out[w] = ((right[w] & NOT_FIRST_COLUMN[w]) | (left[w] & NOT_LAST_COLUMN[w]) |
+                      below[w] | above[w]) & ALL_CELLS[w];
+        }
+        return out;
+    }
+
+    Mask planes[2] = {};
+    uint64_t cellHash = 0;
+};
+
+// BitGame's counterpart on a FixedBoard<N>, with the same search interface, so
+// MCTS can be instantiated on either. Target masks are recomputed when asked
+// for; at one to three words that is cheaper than maintaining them.
+template <int N>
+struct FixedGame {
+    using Mask = typename FixedBoard<N>::Mask;
+
+    int impulseCost = IMPULSE_COST;
+    int targetCells = targetCellsFor(N, WIN_PERCENTAGE);
+    FixedBoard<N> board;
+    int charges[2] = {0, 0};
+    CellState toMove = CellState::PLAYER;
+    GameResult outcome = GameResult::NONE;
+    int turn = 0;
+
+    void load(const GameState& state) {
+        impulseCost = state.rules.impulseCost;
+        targetCells = state.rules.targetCells();
+        board.load(state.board);
+        charges[0] = state.playerCharges;
+        charges[1] = state.aiCharges;
+        toMove = state.toMove;
+        outcome = state.outcome;
+        turn = state.turn;
+    }
+
+    int cells(CellState owner) const { return board.count(owner); }
+    bool canUseImpulse(CellState side) const { return charges[side == CellState::PLAYER ? 0 : 1] >= impulseCost; }
+    bool isOver() const { return outcome != GameResult::NONE; }
+
+    uint64_t hash() const {
+        uint64_t key = board.hash() ^ zobristCharges(0, charges[0]) ^ zobristCharges(1, charges[1]);
+        return toMove == CellState::AI ? key ^ zobristAiToMove() : key;
+    }
+
+    uint64_t hashAfter(const Move& move) const {
+        return hashAfterMove(hash(), toMove, charges[toMove == CellState::PLAYER ? 0 : 1], impulseCost, move);
+    }
+
+    Mask targets(MoveType type) const {
+        return type == MoveType::ATTACK ? board.contested(toMove) : board.frontier(toMove);
+    }
+
+    int targetCount(MoveType type) const { return FixedBoard<N>::countBits(targets(type)); }
+
+    template <typename Fn>
+    void forEachTarget(MoveType type, Fn&& fn) const {
+        Mask mask = targets(type);
+        for (int w = 0; w < FixedBoard<N>::WORDS; w++) {
+            for (uint64_t word = mask[w]; word != 0; word &= word - 1) fn(w * 64 + lowestBit(word));
+        }
+    }
+
+    int sampleTargets(MoveType type, int wanted, int* out, std::mt19937& rng) const {
+        return sampleFrom(targets(type), wanted, out, rng);
+    }
+
+    void applyMove(const Move& move) {
+        if (isOver()) return;
+        int& sideCharges = charges[toMove == CellState::PLAYER ? 0 : 1];
+        for (int i = 0; i < move.count; i++) board.set(move.cells[i], toMove);
+        switch (move.type) {
+            case MoveType::CAPTURE: sideCharges++; break;
+            case MoveType::ATTACK:
+            case MoveType::SPEED: sideCharges -= impulseCost; break;
+            case MoveType::PASS: break;
+        }
+        endTurn();
+    }
+
+    // One move of the chooseRandomMove policy, as BitGame::playRandomMove.
+    void playRandomMove(std::mt19937& rng) {
+        if (isOver()) return;
+
+        int& sideCharges = charges[toMove == CellState::PLAYER ? 0 : 1];
+        bool canImpulse = sideCharges >= impulseCost;
+        int cells[3];
+        int count;
+        bool impulse = true;
+
+        if (canImpulse && coinFlip(rng)) {
+            count = sampleFrom(board.contested(toMove), 2, cells, rng);
+        } else if (canImpulse && coinFlip(rng)) {
+            count = sampleFrom(board.frontier(toMove), 3, cells, rng);
+        } else {
+            count = sampleFrom(board.frontier(toMove), 1, cells, rng);
+            impulse = false;
+        }
+
+        if (count > 0) {
+            for (int i = 0; i < count; i++) board.set(cells[i], toMove);
+            sideCharges += impulse ? -impulseCost : 1;
+        }
+        endTurn();
+    }
+
+private:
+    static int sampleFrom(const Mask& mask, int wanted, int* out, std::mt19937& rng) {
+        int picked = sampleRanks(FixedBoard<N>::countBits(mask), wanted, out, rng);
+        for (int i = 0; i < picked; i++) out[i] = FixedBoard<N>::select(mask, out[i]);
+        return picked;
+    }
+
+    void endTurn() {
+        CellState mover = toMove;
+        toMove = opponentOf(mover);
+        turn++;
+        if (mover != CellState::AI) return;
+
+        int playerCells = cells(CellState::PLAYER);
+        int aiCells = cells(CellState::AI);
+        outcome = resultFromCounts(playerCells, aiCells, targetCells);
+        if (outcome == GameResult::NONE && !FixedBoard<N>::any(board.frontier(CellState::PLAYER)) &&
+            !FixedBoard<N>::any(board.frontier(CellState::AI))) {
+            outcome = sealedResult(playerCells, aiCells, charges[0], charges[1], impulseCost,
+                                   FixedBoard<N>::any(board.contested(CellState::PLAYER)), targetCells);
+        }
+    }
+};
@@ -0,0 +1,21 @@
+#include "greedy_ai.h"
+
+#include "random_ai.h"
+
+Move chooseGreedyMove(const GameState& state, const EvalWeights& weights,
+                      CandidateBatch& frontier, CandidateBatch& contested) {
+    CellState side = state.toMove;
+    auto forEachTarget = [&](MoveType type, auto&& fn) {
+        const CellSet& targets = type == MoveType::ATTACK ? state.board.contested(side) : state.board.frontier(side);
+        for (int cell : targets) fn(cell);
+    };
+    return chooseScoredMove(state.board, side, canUseImpulse(state, side), forEachTarget,
+                            weights, frontier, contested);
+}
+
+Move GreedyAgent::chooseMove(const GameState& state, std::mt19937& rng) {
+    if (greediness < 1.0 && std::uniform_real_distribution<>(0.0, 1.0)(rng) >= greediness) {
+        return chooseRandomMove(state, rng);
+    }
+    return chooseGreedyMove(state, weights, frontier, contested);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "agent.h"
+#include "evaluator.h"
+#include "rules.h"
+#include <random>
+
+// The evaluator's pick for state.toMove among its captures, speed impulses
+// and attacks; see chooseScoredMove(). The batches are scratch space, kept
+// by the caller so repeated calls do not allocate.
+Move chooseGreedyMove(const GameState& state, const EvalWeights& weights,
+                      CandidateBatch& frontier, CandidateBatch& contested);
+
+// Difficulty is the share of moves it plays greedily; the rest come from
+// chooseRandomMove, so 0 plays like RandomAgent and 1 never blunders on
+// purpose.
+class GreedyAgent : public Agent {
+public:
+    explicit GreedyAgent(double greediness = 1.0, const EvalWeights& weights = EvalWeights())
+        : greediness(greediness), weights(weights) {}
+
+    Move chooseMove(const GameState& state, std::mt19937& rng) override;
+
+private:
+    double greediness;
+    EvalWeights weights;
+    CandidateBatch frontier;
+    CandidateBatch contested;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdio>
+
+// A HUD text label that keeps its formatted text and measured width, and only
+// re-formats and re-measures when the values bound to it change. Drawing an
+// unchanged label costs one DrawText and no allocation.
+class HudLabel {
+public:
+    HudLabel(const char* format, int fontSize) : format(format), fontSize(fontSize) {}
+
+    // Binds up to three integers to the printf-style format given at construction.
+    void set(int a, int b = 0, int c = 0) {
+        if (formatted && source == nullptr && values[0] == a && values[1] == b && values[2] == c) return;
+        values[0] = a;
+        values[1] = b;
+        values[2] = c;
+        source = nullptr;
+        std::snprintf(text, sizeof(text), format, a, b, c);
+        measure();
+    }
+
+    // Binds a string with static storage; it is compared by address.
+    void setText(const char* staticText) {
+        if (formatted && source == staticText) return;
+        source = staticText;
+        std::snprintf(text, sizeof(text), "%s", staticText);
+        measure();
+    }
+
+    void draw(int x, int y, Color color) const {
+        DrawText(text, x, y, fontSize, color);
+    }
+
+    void drawCentered(int centerX, int y, Color color) const {
+        DrawText(text, centerX - width / 2, y, fontSize, color);
+    }
+
+    int measuredWidth() const { return width; }
+
+private:
+    void measure() {
+        width = MeasureText(text, fontSize);
+        formatted = true;
+    }
+
+    const char* format;
+    int fontSize;
+    const char* source = nullptr;
+    int values[3] = {0, 0, 0};
+    bool formatted = false;
+    char text[96] = {};
+    int width = 0;
+};
@@ -1,53 +1,162 @@
 #include "raylib.h"
+#include "rules.h"
+#include "mcts.h"
+#include "net_client.h"
+#include "replay.h"
+#include "tablebase.h"
+#include "telemetry.h"
+#include "thread_pool.h"
+#include "tournament.h"
+#include "hud.h"
+#include "profiler.h"
+#include "assets.h"
+#include "board_renderer.h"
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 
 const int WINDOW_WIDTH = 1024;
 const int WINDOW_HEIGHT = 768;
-const int DEFAULT_GRID_SIZE = 10;
-const int IMPULSE_COST = 3;
-const float AI_DELAY = 1.0f;
-const int WIN_PERCENTAGE = 45;
-
-enum class CellState { NEUTRAL, PLAYER, AI };
-enum class GameState { MENU, PLAYING, GAME_OVER };
-enum class GameResult { NONE, PLAYER_WIN, AI_WIN, DRAW };
+const float AI_DELAY = 1.0f;        // minimum time an AI turn stays on screen
+const double AI_THINK_TIME = DEFAULT_THINK_TIME;
+const int MIN_LARGE_GRID_SIZE = 16;
+const int MAX_GRID_SIZE = 1024;
+const int CHUNK_CELLS = 32;         // board cache tile, in cells per side
+const int MIN_CELL_TEXELS = 4;      // texture resolution floor for big boards
+const int MAX_BOARD_TEXELS = 4096;  // ...unless that would exceed this per side
+const float MAX_CELL_ZOOM_PIXELS = 200.0f;
+const double IDLE_TICK = 1.0 / 30.0;  // loop period while nothing needs drawing
+const double IDLE_REFRESH = 1.0;      // ...but a frame is drawn at least this often
+const double MUSIC_STARVED = 0.1;     // a gap between stream updates this long likely ran the music dry
+
+enum class AppState { MENU, PLAYING, GAME_OVER };
 enum class ImpulseMode { NONE, ATTACK, SPEED };
 
-GameState currentState = GameState::MENU;
-GameResult gameResult = GameResult::NONE;
+AppState currentState = AppState::MENU;
 int gridSize = DEFAULT_GRID_SIZE;
-int impulseCost = IMPULSE_COST;
-bool playerTurn = true;
 bool impulseModeActive = false;
 ImpulseMode currentImpulseMode = ImpulseMode::NONE;
 bool musicEnabled = true;
 
 // menu
-int selectedGridSize = 1; // 0 = 7x7, 1 = 10x10, 2 = 12x12
-bool gridSizeButtons[3] = {false, true, false};
+int selectedGridSize = 1; // 0 = 7x7, 1 = 10x10, 2 = 12x12, 3 = large
+bool gridSizeButtons[4] = {false, true, false, false};
+int largeGridSize = 256;
 bool musicButtonActive = true;
+bool profilerOverlay = false;
+
+// idle rendering: a frame is drawn only after input or when the scene
+// changed, otherwise the loop polls input, feeds the music stream and sleeps.
+// frameTime is the time since the previous loop pass, drawn or not, which
+// GetFrameTime() stops measuring once frames are skipped.
+struct SceneStamp {
+    AppState state;
+    uint32_t revision;
+    int turn;
+    bool impulseMode;
+    size_t selected;
+    bool music;
+    bool awaitingServer;
+    Camera2D camera;
+};
+SceneStamp drawnScene = {};
+double lastDrawTime = 0.0;
+float frameTime = 0.0f;
+
+// match
+Rules rules;
+GameState game;
+MoveJournal history;
+
+// every match is seeded from sessionSeed and its number, as the tournament
+// seeds games, and with --record streamed to replayLog a move at a time
+uint32_t sessionSeed = std::random_device{}();
+uint64_t matchesStarted = 0;
+ReplayEncoder replay;
+ReplayFile replayLog;
 
-// grid
-std::vector<std::vector<CellState>> grid;
-int playerCells = 1;
-int aiCells = 1;
-int playerCharges = 0;
-int aiCharges = 0;
+// --telemetry FILE: frame times, turns, AI searches, impulses, match results
+// and music underruns, appended in line protocol by a background thread
+double turnStartedAt = 0.0;
+double musicFedAt = 0.0;
 
-// AI
+// network play (--connect host[:port]): the server runs the match and the AI,
+// the player's moves go out as requests and every move, ours included, is
+// applied only when the server echoes it. Boards larger than a server hosts,
+// and matches it turns down, are played locally against the local AI.
+NetClient server;
+bool playingOnline = false;
+uint64_t onlineMatch = 0;
+bool awaitingServer = false;
+
+// AI, searched on a worker thread; the agent, rng and aiPosition belong to
+// the worker until aiMoveReady is set or it has been joined. The worker grows
+// one search tree per shared pool thread (--ai-threads, by default a thread
+// per core less the one drawing), so one core means a plain serial search.
 float aiTimer = 0.0f;
-std::mt19937 rng(std::random_device{}());
+int aiThreads = 0;
+// solved 7x7 endgames (--tablebase, made by terra_tablebase); optional
+Tablebase tablebase;
+std::string tablebasePath = "assets/tablebase7.bin";
+std::mt19937 rng;
+std::atomic<bool> aiCancel{false};
+std::atomic<bool> aiMoveReady{false};
+MctsAgent aiAgent;
+GameState aiPosition;
+Move aiMove;
+std::thread aiThread;
 
-// UI
-float cellSize;
+// UI: the board lives in world space at (0, 0) with cellSize units per cell,
+// and the camera maps it onto the screen area starting at gridOffsetX/Y
+int cellSize;
 float gridOffsetX;
 float gridOffsetY;
+float boardViewSize;
+float fitZoom = 1.0f;
+Camera2D camera = {};
 std::pair<int, int> selectedCell = {-1, -1};
 std::vector<std::pair<int, int>> selectedCells;
+CellMask selectedMask;  // the same cells by index, for membership tests
+
+// board drawing: one shader pass over a texel-per-cell board texture where
+// the GPU can compile it, otherwise the board cache below: cell fills in
+// CHUNK_CELLS-square tiles created when first visible and redrawn only where
+// the board changed, plus one grid-line tile shared by every chunk
+BoardRenderer boardRenderer;
+struct BoardChunk {
+    RenderTexture2D texture;
+    bool ready = false;
+};
+std::vector<BoardChunk> boardChunks;
+int chunksPerSide = 0;
+RenderTexture2D chunkLines;
+bool boardCacheReady = false;
+std::vector<CellState> cachedCells;
+uint32_t cachedRevision = 0;
+
+// HUD
+HudLabel targetLabel("Target: %d cells (%d%%)", 20);
+HudLabel playerCellsLabel("Player: %d/%d", 20);
+HudLabel aiCellsLabel("AI: %d/%d", 20);
+HudLabel playerChargesLabel("Charges: %d", 20);
+HudLabel aiChargesLabel("AI Charges: %d", 20);
+HudLabel turnLabel("%s", 30);
+HudLabel modeLabel("%s", 20);
+HudLabel selectedLabel("Selected: %d/%d", 20);
+HudLabel musicLabel("%s", 15);
+HudLabel resultLabel("%s", 80);
+HudLabel finalScoreLabel("Final Score: Player %d - AI %d", 30);
+HudLabel returnLabel("%s", 20);
+HudLabel gameOverMusicLabel("%s", 15);
+HudLabel largeSizeLabel("%dx%d", 20);
+HudLabel winRuleLabel("- First to %d%% of the board wins!", 15);
 
 Sound captureSound;
 Sound impulseSound;
@@ -56,27 +165,54 @@ Sound winSound;
 Sound loseSound;
 Sound drawSound;
 Music backgroundMusic;
+SoundCache soundCache;
+bool soundsReady = false;
+
+// assets come from the bundle terra_pack built into the executable
+// (TERRA_EMBED_ASSETS) or from assets.pak beside it (--assets FILE), and
+// from loose files under assets/ only when there is neither
+AssetBundle assetBundle;
+std::string assetBundlePath = "assets.pak";
+#if defined(TERRA_EMBEDDED_ASSETS)
+extern const unsigned char TERRA_ASSET_BUNDLE[];
+extern const size_t TERRA_ASSET_BUNDLE_SIZE;
+#endif
 
 void initializeGame();
 void resetGame();
+void updateGridLayout();
+void resetCamera();
+void updateCamera();
+bool screenToCell(Vector2 screen, int& x, int& y);
+int menuGridSize();
+void selectGridSize(int option);
 void updateGame(float deltaTime);
 void renderGame();
 void handleInput();
 void processPlayerTurn();
 void processAITurn(float deltaTime);
-void checkWinCondition();
-std::vector<std::pair<int, int>> getAvailableMoves(CellState player);
-bool isValidMove(int x, int y, CellState player);
-std::vector<std::pair<int, int>> getAdjacentCells(int x, int y);
-void renderCell(int x, int y, CellState state, bool isSelected = false);
+void pollServer();
+void leaveOnlineMatch();
+void startAIThinking();
+void cancelAIThinking();
+Color cellColor(CellState state, bool isSelected);
+void rebuildBoardCache();
+void releaseBoardCache();
+void visibleChunks(int& firstX, int& firstY, int& lastX, int& lastY);
+void paintChunk(int chunk, bool changedOnly);
+void updateBoardCache();
+void renderBoard();
 void startImpulseMode(ImpulseMode mode);
 void handleImpulseCellSelection(int x, int y);
 void finishImpulseMode();
-std::pair<int, int> getAIMove();
-std::vector<std::pair<int, int>> getAIAttackMove();
-std::vector<std::pair<int, int>> getAISpeedMove();
-ImpulseMode decideAIImpulseMode();
+bool playMove(const Move& move);
+bool applyLocalMove(const Move& move);
+void playMoveSound(const Move& move);
+void recordMoveTelemetry(CellState mover, int turn, const Move& move);
+bool undoLastTurn();
+void finishRecording();
 void loadSounds();
+void bindSounds();
 void playCaptureSound();
 void playImpulseSound();
 void playAttackSound();
@@ -86,72 +222,170 @@ void playDrawSound();
 void toggleMusic();
 void renderMenuButtons();
 void updateMenu();
+void renderProfilerOverlay();
+SceneStamp sceneStamp();
+bool sceneChanged(const SceneStamp& a, const SceneStamp& b);
+bool inputArrived();
 
-int main() {
+int main(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--seed") == 0) {
+            sessionSeed = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--record") == 0 && !replayLog.open(argv[i + 1])) {
+            TraceLog(LOG_WARNING, "cannot append to replay log %s", argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--telemetry") == 0 && !telemetry().start(argv[i + 1])) {
+            TraceLog(LOG_WARNING, "cannot append to telemetry file %s", argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--assets") == 0) {
+            assetBundlePath = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--tablebase") == 0) {
+            tablebasePath = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--ai-threads") == 0) {
+            aiThreads = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--connect") == 0) {
+            std::string host = argv[i + 1];
+            uint16_t port = DEFAULT_SERVER_PORT;
+            size_t colon = host.rfind(':');
+            if (colon != std::string::npos) {
+                port = static_cast<uint16_t>(std::atoi(host.c_str() + colon + 1));
+                host.resize(colon);
+            }
+            if (!server.connect(host.c_str(), port)) {
+                TraceLog(LOG_WARNING, "cannot reach server %s:%u, playing offline", host.c_str(), port);
+            }
+        }
+    }
+    TraceLog(LOG_INFO, "session seed %u", sessionSeed);
+    rng.seed(sessionSeed);
+    
     InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Territorial Control");
     SetTargetFPS(60);
     
     InitAudioDevice();
     loadSounds();
     
-    if (musicEnabled) {
-        PlayMusicStream(backgroundMusic);
-    }
-    
     initializeGame();
     
+    MctsConfig aiConfig;
+    aiConfig.timeBudget = AI_THINK_TIME;
+    aiConfig.cancel = &aiCancel;
+    if (aiThreads <= 0) aiThreads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    setSharedPoolThreads(aiThreads);
+    aiConfig.threads = 0;
+    if (tablebase.open(tablebasePath.c_str())) {
+        TraceLog(LOG_INFO, "tablebase %s: %llu solved positions", tablebasePath.c_str(),
+                 (unsigned long long)tablebase.size());
+        aiConfig.tablebase = &tablebase;
+    }
+    aiAgent = MctsAgent(aiConfig);
+    
+    double lastTick = GetTime();
     while (!WindowShouldClose()) {
-        float deltaTime = GetFrameTime();
+        double now = GetTime();
+        float deltaTime = (float)(now - lastTick);
+        lastTick = now;
+        frameTime = deltaTime;
+        PROFILE_FRAME(deltaTime);
         
-        UpdateMusicStream(backgroundMusic);
+        if (!soundsReady && soundCache.poll()) {
+            bindSounds();
+        }
+        {
+            PROFILE_ZONE("UpdateMusicStream");
+            if (soundsReady && IsMusicStreamPlaying(backgroundMusic) && now - musicFedAt > MUSIC_STARVED) {
+                TelemetrySample sample;
+                sample.event = TelemetryEvent::AUDIO_UNDERRUN;
+                sample.match = matchesStarted;
+                sample.value = (uint64_t)((now - musicFedAt) * 1e9);
+                recordTelemetry(sample);
+            }
+            UpdateMusicStream(backgroundMusic);
+            musicFedAt = now;
+        }
         
         handleInput();
         updateGame(deltaTime);
         
+        if (currentState == AppState::PLAYING) {
+            updateBoardCache();
+        }
+        
+        SceneStamp scene = sceneStamp();
+        if (!profilerOverlay && !inputArrived() && !sceneChanged(scene, drawnScene) &&
+            now - lastDrawTime < IDLE_REFRESH) {
+            PollInputEvents();
+            WaitTime(IDLE_TICK);
+            continue;
+        }
+        drawnScene = scene;
+        lastDrawTime = now;
+        
         BeginDrawing();
         ClearBackground(BLACK);
         renderGame();
-        EndDrawing();
+        renderProfilerOverlay();
+        {
+            PROFILE_ZONE("EndDrawing");
+            EndDrawing();
+        }
+        TelemetrySample frame;
+        frame.event = TelemetryEvent::FRAME;
+        frame.match = matchesStarted;
+        frame.value = (uint64_t)(deltaTime * 1e9);
+        recordTelemetry(frame);
     }
     
-    UnloadSound(captureSound);
-    UnloadSound(impulseSound);
-    UnloadSound(attackSound);
-    UnloadSound(winSound);
-    UnloadSound(loseSound);
-    UnloadSound(drawSound);
-    UnloadMusicStream(backgroundMusic);
+    cancelAIThinking();
+    finishRecording();
+    leaveOnlineMatch();
+    server.poll(0);
+    server.disconnect();
+    
+    soundCache.unload();
+    assetBundle.close();
     CloseAudioDevice();
+    telemetry().stop();
+    
+    releaseBoardCache();
     
     CloseWindow();
     return 0;
 }
 
+// Decoding starts on a loader thread; the menu runs on silent, empty handles
+// until bindSounds() swaps in the real ones.
 void loadSounds() {
-    captureSound = LoadSound("assets/sounds/Key.mp3");
-    if (captureSound.stream.buffer == NULL) {
-        TraceLog(LOG_WARNING, "Failed to load capture sound");
-    }
-    
-    impulseSound = LoadSound("assets/sounds/Door.mp3");
-    if (impulseSound.stream.buffer == NULL) {
-        TraceLog(LOG_WARNING, "Failed to load impulse sound");
-    }
-    
-    attackSound = LoadSound("assets/sounds/Clark.mp3");
-    if (attackSound.stream.buffer == NULL) {
-        TraceLog(LOG_WARNING, "Failed to load attack sound");
+#if defined(TERRA_EMBEDDED_ASSETS)
+    bool bundled = assetBundle.openMemory(TERRA_ASSET_BUNDLE, TERRA_ASSET_BUNDLE_SIZE);
+#else
+    bool bundled = assetBundle.open(assetBundlePath.c_str());
+#endif
+    if (bundled) {
+        TraceLog(LOG_INFO, "asset bundle: %d assets", assetBundle.count());
+    } else {
+        TraceLog(LOG_INFO, "no asset bundle, loading assets from loose files");
     }
+    soundCache.start({"assets/sounds/Key.mp3", "assets/sounds/Door.mp3", "assets/sounds/Clark.mp3"},
+                     bundled ? &assetBundle : nullptr);
+}
+
+void bindSounds() {
+    soundsReady = true;
+    captureSound = soundCache.sound("assets/sounds/Key.mp3");
+    impulseSound = soundCache.sound("assets/sounds/Door.mp3");
+    attackSound = soundCache.sound("assets/sounds/Clark.mp3");
+    winSound = soundCache.sound("assets/sounds/Key.mp3");
+    loseSound = soundCache.sound("assets/sounds/Door.mp3");
+    drawSound = soundCache.sound("assets/sounds/Clark.mp3");
     
-    winSound = LoadSound("assets/sounds/Key.mp3");
-    loseSound = LoadSound("assets/sounds/Door.mp3");
-    drawSound = LoadSound("assets/sounds/Clark.mp3");
-    
-    backgroundMusic = LoadMusicStream("assets/sounds/Key.mp3");
+    backgroundMusic = soundCache.music("assets/sounds/Key.mp3");
     if (backgroundMusic.stream.buffer == NULL) {
         TraceLog(LOG_WARNING, "Failed to load background music");
-    } else {
-        backgroundMusic.looping = true;
+        return;
+    }
+    backgroundMusic.looping = true;
+    PlayMusicStream(backgroundMusic);
+    if (!musicEnabled) {
+        PauseMusicStream(backgroundMusic);
     }
 }
 
@@ -201,59 +435,114 @@ void toggleMusic() {
 }
 
 void initializeGame() {
-    grid.resize(gridSize, std::vector<CellState>(gridSize, CellState::NEUTRAL));
-    
-    grid[0][0] = CellState::PLAYER;
-    grid[gridSize-1][gridSize-1] = CellState::AI;
-    
-    playerCells = 1;
-    aiCells = 1;
-    playerCharges = 0;
-    aiCharges = 0;
-    playerTurn = true;
+    rules.gridSize = gridSize;
+    game.reset(rules);
+    history.clear();
     impulseModeActive = false;
     currentImpulseMode = ImpulseMode::NONE;
+    selectedCells.reserve(3);
+    selectedMask.reset(gridSize * gridSize);
     
+    updateGridLayout();
+    rebuildBoardCache();
+}
+
+void updateGridLayout() {
     float maxGridSize = std::min(WINDOW_WIDTH * 0.8f, WINDOW_HEIGHT * 0.8f);
-    cellSize = maxGridSize / gridSize;
-    gridOffsetX = (WINDOW_WIDTH - cellSize * gridSize) / 2;
-    gridOffsetY = (WINDOW_HEIGHT - cellSize * gridSize) / 2 + 50;
+    int fitCell = (int)(maxGridSize / gridSize);
+    cellSize = std::max(fitCell, std::max(1, std::min(MIN_CELL_TEXELS, MAX_BOARD_TEXELS / gridSize)));
+    fitZoom = std::min(1.0f, maxGridSize / (cellSize * gridSize));
+    boardViewSize = cellSize * gridSize * fitZoom;
+    gridOffsetX = (WINDOW_WIDTH - boardViewSize) / 2;
+    gridOffsetY = (WINDOW_HEIGHT - boardViewSize) / 2 + 50;
+    resetCamera();
 }
 
-void resetGame() {
-    for (int x = 0; x < gridSize; x++) {
-        for (int y = 0; y < gridSize; y++) {
-            grid[x][y] = CellState::NEUTRAL;
-        }
+void resetCamera() {
+    camera.offset = Vector2{gridOffsetX, gridOffsetY};
+    camera.target = Vector2{0, 0};
+    camera.rotation = 0.0f;
+    camera.zoom = fitZoom;
+}
+
+void updateCamera() {
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0.0f) {
+        // zoom around the cursor
+        Vector2 mousePos = GetMousePosition();
+        camera.target = GetScreenToWorld2D(mousePos, camera);
+        camera.offset = mousePos;
+        float maxZoom = std::max(fitZoom, MAX_CELL_ZOOM_PIXELS / cellSize);
+        camera.zoom = std::clamp(camera.zoom * (wheel > 0 ? 1.25f : 0.8f), fitZoom * 0.5f, maxZoom);
+    }
+    
+    if (IsMouseButtonDown(MOUSE_RIGHT_BUTTON) || IsMouseButtonDown(MOUSE_MIDDLE_BUTTON)) {
+        Vector2 delta = GetMouseDelta();
+        camera.target.x -= delta.x / camera.zoom;
+        camera.target.y -= delta.y / camera.zoom;
     }
     
-    grid[0][0] = CellState::PLAYER;
-    grid[gridSize-1][gridSize-1] = CellState::AI;
+    float pan = 600.0f * frameTime / camera.zoom;
+    if (IsKeyDown(KEY_LEFT)) camera.target.x -= pan;
+    if (IsKeyDown(KEY_RIGHT)) camera.target.x += pan;
+    if (IsKeyDown(KEY_UP)) camera.target.y -= pan;
+    if (IsKeyDown(KEY_DOWN)) camera.target.y += pan;
+    
+    if (IsKeyPressed(KEY_HOME)) {
+        resetCamera();
+    }
+}
+
+bool screenToCell(Vector2 screen, int& x, int& y) {
+    Vector2 world = GetScreenToWorld2D(screen, camera);
+    x = (int)std::floor(world.x / cellSize);
+    y = (int)std::floor(world.y / cellSize);
+    return game.board.inBounds(x, y);
+}
+
+void resetGame() {
+    cancelAIThinking();
+    finishRecording();
+    rules.gridSize = gridSize;
+    game.reset(rules);
+    history.clear();
+    seedGame(rng, sessionSeed, static_cast<long long>(matchesStarted));
+    if (replayLog.isOpen()) {
+        replay.beginGame(rules, sessionSeed, matchesStarted);
+    }
+    matchesStarted++;
+    turnStartedAt = GetTime();
     
-    playerCells = 1;
-    aiCells = 1;
-    playerCharges = 0;
-    aiCharges = 0;
-    playerTurn = true;
+    leaveOnlineMatch();
+    playingOnline = server.connected() && gridSize <= DEFAULT_SERVER_MAX_GRID_SIZE;
+    if (playingOnline) {
+        server.createMatch(rules, (int)(AI_THINK_TIME * 1000));
+        awaitingServer = true;
+    } else if (server.connected()) {
+        TraceLog(LOG_INFO, "%dx%d is larger than the server hosts, playing this match locally", gridSize, gridSize);
+    }
     impulseModeActive = false;
     currentImpulseMode = ImpulseMode::NONE;
+    updateGridLayout();
+    rebuildBoardCache();
     selectedCell = {-1, -1};
     selectedCells.clear();
-    gameResult = GameResult::NONE;
-    currentState = GameState::PLAYING;
+    selectedMask.reset(gridSize * gridSize);
+    currentState = AppState::PLAYING;
 }
 
 void updateGame(float deltaTime) {
+    PROFILE_ZONE("updateGame");
     switch (currentState) {
-        case GameState::MENU:
+        case AppState::MENU:
             updateMenu();
             break;
             
-        case GameState::PLAYING:
-            if (gameResult != GameResult::NONE) {
-                currentState = GameState::GAME_OVER;
+        case AppState::PLAYING:
+            if (game.isOver()) {
+                currentState = AppState::GAME_OVER;
                 
-                switch (gameResult) {
+                switch (game.outcome) {
                     case GameResult::PLAYER_WIN:
                         playWinSound();
                         break;
@@ -269,54 +558,94 @@ void updateGame(float deltaTime) {
                 break;
             }
             
-            if (playerTurn) {
+            if (playingOnline) {
+                pollServer();
+                if (game.toMove == CellState::PLAYER) {
+                    processPlayerTurn();
+                }
+            } else if (game.toMove == CellState::PLAYER) {
                 processPlayerTurn();
             } else {
                 processAITurn(deltaTime);
             }
             break;
             
-        case GameState::GAME_OVER:
+        case AppState::GAME_OVER:
             if (IsKeyPressed(KEY_R) || IsKeyPressed(KEY_ESCAPE)) {
-                currentState = GameState::MENU;
+                cancelAIThinking();
+                finishRecording();
+                leaveOnlineMatch();
+                currentState = AppState::MENU;
+            } else if (IsKeyPressed(KEY_U) && undoLastTurn()) {
+                currentState = AppState::PLAYING;
             }
             break;
     }
 }
 
+int menuGridSize() {
+    switch (selectedGridSize) {
+        case 0: return 7;
+        case 1: return 10;
+        case 2: return 12;
+        default: return largeGridSize;
+    }
+}
+
+void selectGridSize(int option) {
+    selectedGridSize = option;
+    for (int i = 0; i < 4; i++) {
+        gridSizeButtons[i] = i == option;
+    }
+}
+
 void updateMenu() {
     Vector2 mousePos = GetMousePosition();
     
     // 7x7
     if (CheckCollisionPointRec(mousePos, Rectangle{200, 200, 100, 40})) {
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-            selectedGridSize = 0;
-            gridSizeButtons[0] = true;
-            gridSizeButtons[1] = false;
-            gridSizeButtons[2] = false;
+            selectGridSize(0);
         }
     }
     
     // 10x10
     if (CheckCollisionPointRec(mousePos, Rectangle{320, 200, 100, 40})) {
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-            selectedGridSize = 1;
-            gridSizeButtons[0] = false;
-            gridSizeButtons[1] = true;
-            gridSizeButtons[2] = false;
+            selectGridSize(1);
         }
     }
     
     // 12x12
     if (CheckCollisionPointRec(mousePos, Rectangle{440, 200, 100, 40})) {
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-            selectedGridSize = 2;
-            gridSizeButtons[0] = false;
-            gridSizeButtons[1] = false;
-            gridSizeButtons[2] = true;
+            selectGridSize(2);
         }
     }
     
+    // large, clicking again doubles the size and wraps around
+    if (CheckCollisionPointRec(mousePos, Rectangle{560, 200, 140, 40})) {
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            if (selectedGridSize == 3) {
+                largeGridSize = largeGridSize >= MAX_GRID_SIZE ? MIN_LARGE_GRID_SIZE : largeGridSize * 2;
+            }
+            selectGridSize(3);
+        }
+    }
+    
+    if (IsKeyPressed(KEY_LEFT)) {
+        selectGridSize(std::max(0, selectedGridSize - 1));
+    }
+    if (IsKeyPressed(KEY_RIGHT)) {
+        selectGridSize(std::min(3, selectedGridSize + 1));
+    }
+    if (selectedGridSize == 3 && IsKeyPressed(KEY_UP)) {
+        largeGridSize = std::min(MAX_GRID_SIZE, largeGridSize * 2);
+    }
+    if (selectedGridSize == 3 && IsKeyPressed(KEY_DOWN)) {
+        largeGridSize = std::max(MIN_LARGE_GRID_SIZE, largeGridSize / 2);
+    }
+    
     if (CheckCollisionPointRec(mousePos, Rectangle{200, 260, 200, 40})) {
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
             toggleMusic();
@@ -326,14 +655,9 @@ void updateMenu() {
     
     if (CheckCollisionPointRec(mousePos, Rectangle{WINDOW_WIDTH/2 - 100, 350, 200, 50})) {
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-            switch(selectedGridSize) {
-                case 0: gridSize = 7; break;
-                case 1: gridSize = 10; break;
-                case 2: gridSize = 12; break;
-            }
-            
+            gridSize = menuGridSize();
             resetGame();
-            currentState = GameState::PLAYING;
+            currentState = AppState::PLAYING;
         }
     }
     
@@ -343,15 +667,10 @@ void updateMenu() {
         }
     }
     
-    if (IsKeyPressed(KEY_SPACE)) {
-        switch(selectedGridSize) {
-            case 0: gridSize = 7; break;
-            case 1: gridSize = 10; break;
-            case 2: gridSize = 12; break;
-        }
-        
+    if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER)) {
+        gridSize = menuGridSize();
         resetGame();
-        currentState = GameState::PLAYING;
+        currentState = AppState::PLAYING;
     }
     
     if (IsKeyPressed(KEY_ESCAPE)) {
@@ -365,76 +684,62 @@ void updateMenu() {
 }
 
 void renderGame() {
+    PROFILE_ZONE("renderGame");
     switch (currentState) {
-        case GameState::MENU:
+        case AppState::MENU:
             renderMenuButtons();
             break;
             
-        case GameState::PLAYING:
+        case AppState::PLAYING:
             {
-                for (int x = 0; x < gridSize; x++) {
-                    for (int y = 0; y < gridSize; y++) {
-                        bool isSelected = false;
-                        if (impulseModeActive) {
-                            for (auto& cell : selectedCells) {
-                                if (x == cell.first && y == cell.second) {
-                                    isSelected = true;
-                                    break;
-                                }
-                            }
-                        }
-                        renderCell(x, y, grid[x][y], isSelected);
-                    }
-                }
+                renderBoard();
                 
                 // UI
-                int targetCells = (gridSize * gridSize * WIN_PERCENTAGE + 99) / 100;
-                std::string targetStr = "Target: " + std::to_string(targetCells) + " cells (" + std::to_string(WIN_PERCENTAGE) + "%)";
-                DrawText(targetStr.c_str(), WINDOW_WIDTH/2 - MeasureText(targetStr.c_str(), 20)/2, gridOffsetY - 40, 20, WHITE);
+                int targetCells = rules.targetCells();
+                targetLabel.set(targetCells, rules.winPercentage);
+                targetLabel.drawCentered(WINDOW_WIDTH/2, gridOffsetY - 40, WHITE);
                 
-                std::string playerStr = "Player: " + std::to_string(playerCells) + "/" + std::to_string(targetCells);
-                DrawText(playerStr.c_str(), WINDOW_WIDTH/2 - MeasureText(playerStr.c_str(), 20)/2, gridOffsetY + gridSize * cellSize + 10, 20, BLUE);
+                playerCellsLabel.set(game.cells(CellState::PLAYER), targetCells);
+                playerCellsLabel.drawCentered(WINDOW_WIDTH/2, gridOffsetY + boardViewSize + 10, BLUE);
                 
-                std::string aiStr = "AI: " + std::to_string(aiCells) + "/" + std::to_string(targetCells);
-                DrawText(aiStr.c_str(), WINDOW_WIDTH/2 - MeasureText(aiStr.c_str(), 20)/2, gridOffsetY - 30, 20, RED);
+                aiCellsLabel.set(game.cells(CellState::AI), targetCells);
+                aiCellsLabel.drawCentered(WINDOW_WIDTH/2, gridOffsetY - 30, RED);
                 
-                std::string playerChargesStr = "Charges: " + std::to_string(playerCharges);
-                DrawText(playerChargesStr.c_str(), WINDOW_WIDTH - 200, 50, 20, BLUE);
+                playerChargesLabel.set(game.playerCharges);
+                playerChargesLabel.draw(WINDOW_WIDTH - 200, 50, BLUE);
                 
-                std::string aiChargesStr = "AI Charges: " + std::to_string(aiCharges);
-                DrawText(aiChargesStr.c_str(), 50, 50, 20, RED);
+                aiChargesLabel.set(game.aiCharges);
+                aiChargesLabel.draw(50, 50, RED);
                 
                 // turn
-                std::string turnStr = playerTurn ? "YOUR TURN" : "AI TURN";
-                Color turnColor = playerTurn ? BLUE : RED;
-                DrawText(turnStr.c_str(), WINDOW_WIDTH/2 - MeasureText(turnStr.c_str(), 30)/2, 20, 30, turnColor);
+                bool playerTurn = game.toMove == CellState::PLAYER;
+                turnLabel.setText(playerTurn ? "YOUR TURN" : "AI TURN");
+                turnLabel.drawCentered(WINDOW_WIDTH/2, 20, playerTurn ? BLUE : RED);
                 
                 // impulse
                 if (impulseModeActive) {
-                    std::string modeStr = currentImpulseMode == ImpulseMode::ATTACK ? 
-                                        "ATTACK MODE: Select 2 enemy cells (left click)" : 
-                                        "SPEED MODE: Select 3 neutral cells (left click)";
-                    DrawText(modeStr.c_str(), WINDOW_WIDTH/2 - MeasureText(modeStr.c_str(), 20)/2, WINDOW_HEIGHT - 40, 20, YELLOW);
+                    bool attack = currentImpulseMode == ImpulseMode::ATTACK;
+                    modeLabel.setText(attack ? "ATTACK MODE: Select 2 enemy cells (left click)" :
+                                               "SPEED MODE: Select 3 neutral cells (left click)");
+                    modeLabel.drawCentered(WINDOW_WIDTH/2, WINDOW_HEIGHT - 40, YELLOW);
                     
-                    std::string countStr = "Selected: " + std::to_string(selectedCells.size()) + "/" + 
-                                         (currentImpulseMode == ImpulseMode::ATTACK ? "2" : "3");
-                    DrawText(countStr.c_str(), WINDOW_WIDTH/2 - MeasureText(countStr.c_str(), 20)/2, WINDOW_HEIGHT - 65, 20, WHITE);
+                    selectedLabel.set((int)selectedCells.size(), attack ? 2 : 3);
+                    selectedLabel.drawCentered(WINDOW_WIDTH/2, WINDOW_HEIGHT - 65, WHITE);
                 }
                 
-                std::string musicStatus = musicEnabled ? "MUSIC: ON" : "MUSIC: OFF";
-                Color musicColor = musicEnabled ? GREEN : GRAY;
-                DrawText(musicStatus.c_str(), WINDOW_WIDTH - 150, WINDOW_HEIGHT - 20, 15, musicColor);
+                musicLabel.setText(musicEnabled ? "MUSIC: ON" : "MUSIC: OFF");
+                musicLabel.draw(WINDOW_WIDTH - 150, WINDOW_HEIGHT - 20, musicEnabled ? GREEN : GRAY);
             }
             break;
             
-        case GameState::GAME_OVER:
+        case AppState::GAME_OVER:
             {
                 DrawRectangle(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, Fade(BLACK, 0.7f));
                 
                 const char* resultText = "";
                 Color resultColor = WHITE;
                 
-                switch (gameResult) {
+                switch (game.outcome) {
                     case GameResult::PLAYER_WIN:
                         resultText = "VICTORY!";
                         resultColor = GREEN;
@@ -453,16 +758,17 @@ void renderGame() {
                         break;
                 }
                 
-                DrawText(resultText, WINDOW_WIDTH/2 - MeasureText(resultText, 80)/2, WINDOW_HEIGHT/2 - 100, 80, resultColor);
+                resultLabel.setText(resultText);
+                resultLabel.drawCentered(WINDOW_WIDTH/2, WINDOW_HEIGHT/2 - 100, resultColor);
                 
-                std::string finalScore = "Final Score: Player " + std::to_string(playerCells) + " - AI " + std::to_string(aiCells);
-                DrawText(finalScore.c_str(), WINDOW_WIDTH/2 - MeasureText(finalScore.c_str(), 30)/2, WINDOW_HEIGHT/2, 30, WHITE);
+                finalScoreLabel.set(game.cells(CellState::PLAYER), game.cells(CellState::AI));
+                finalScoreLabel.drawCentered(WINDOW_WIDTH/2, WINDOW_HEIGHT/2, WHITE);
                 
-                DrawText("Press R or ESC to return to menu", WINDOW_WIDTH/2 - MeasureText("Press R or ESC to return to menu", 20)/2, WINDOW_HEIGHT/2 + 80, 20, YELLOW);
+                returnLabel.setText("Press R or ESC to return to menu, U to undo");
+                returnLabel.drawCentered(WINDOW_WIDTH/2, WINDOW_HEIGHT/2 + 80, YELLOW);
                 
-                std::string musicStatus = musicEnabled ? "Music: ON (M to toggle)" : "Music: OFF (M to toggle)";
-                Color musicColor = musicEnabled ? GREEN : GRAY;
-                DrawText(musicStatus.c_str(), WINDOW_WIDTH/2 - MeasureText(musicStatus.c_str(), 15)/2, WINDOW_HEIGHT - 30, 15, musicColor);
+                gameOverMusicLabel.setText(musicEnabled ? "Music: ON (M to toggle)" : "Music: OFF (M to toggle)");
+                gameOverMusicLabel.drawCentered(WINDOW_WIDTH/2, WINDOW_HEIGHT - 30, musicEnabled ? GREEN : GRAY);
             }
             break;
     }
@@ -488,6 +794,12 @@ void renderMenuButtons() {
     DrawRectangle(440, 200, 100, 40, button12x12Color);
     DrawText("12x12", 460, 210, 20, BLACK);
     
+    //  large
+    Color buttonLargeColor = gridSizeButtons[3] ? YELLOW : LIGHTGRAY;
+    largeSizeLabel.set(largeGridSize, largeGridSize);
+    DrawRectangle(560, 200, 140, 40, buttonLargeColor);
+    largeSizeLabel.drawCentered(630, 210, BLACK);
+    
     Color musicButtonColor = musicButtonActive ? GREEN : GRAY;
     DrawRectangle(200, 260, 200, 40, musicButtonColor);
     DrawText(musicEnabled ? "MUSIC: ON" : "MUSIC: OFF", 240, 270, 20, BLACK);
@@ -512,42 +824,45 @@ void renderMenuButtons() {
     DrawText("- Press A for ATTACK impulse (remove 2 enemy cells)", 100, 650, 15, LIGHTGRAY);
     DrawText("- Press S for SPEED impulse (capture 3 neutral cells)", 100, 670, 15, LIGHTGRAY);
     
-    std::string winText = "- First to " + std::to_string(WIN_PERCENTAGE) + "% of the board wins!";
-    DrawText(winText.c_str(), 100, 690, 15, GREEN);
+    winRuleLabel.set(rules.winPercentage);
+    winRuleLabel.draw(100, 690, GREEN);
+    DrawText("- Press U to take back your last move", 100, 710, 15, LIGHTGRAY);
 }
 
 void handleInput() {
+    PROFILE_ZONE("handleInput");
+    if (IsKeyPressed(KEY_F3)) {
+        profilerOverlay = !profilerOverlay;
+    }
+    
     switch (currentState) {
-        case GameState::MENU:
+        case AppState::MENU:
             break;
             
-        case GameState::PLAYING:
+        case AppState::PLAYING:
             if (IsKeyPressed(KEY_M)) {
                 toggleMusic();
                 musicButtonActive = musicEnabled;
             }
             
-            if (playerTurn && !impulseModeActive) {
+            updateCamera();
+            
+            if (game.toMove == CellState::PLAYER && !impulseModeActive) {
                 if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mousePos = GetMousePosition();
-                    
-                    int gridX = (mousePos.x - gridOffsetX) / cellSize;
-                    int gridY = (mousePos.y - gridOffsetY) / cellSize;
-                    
-                    if (gridX >= 0 && gridX < gridSize && gridY >= 0 && gridY < gridSize) {
-                        if (grid[gridX][gridY] == CellState::NEUTRAL && isValidMove(gridX, gridY, CellState::PLAYER)) {
-                            grid[gridX][gridY] = CellState::PLAYER;
-                            playerCells++;
-                            playerCharges++;
+                    int gridX, gridY;
+                    if (screenToCell(GetMousePosition(), gridX, gridY)) {
+                        if (playMove(Move::capture(game.board.index(gridX, gridY)))) {
                             playCaptureSound();
-                            
-                            playerTurn = false;
                             aiTimer = 0.0f;
                         }
                     }
                 }
                 
-                if (playerCharges >= impulseCost) {
+                if (IsKeyPressed(KEY_U)) {
+                    undoLastTurn();
+                }
+                
+                if (canUseImpulse(game, CellState::PLAYER)) {
                     if (IsKeyPressed(KEY_A)) {
                         startImpulseMode(ImpulseMode::ATTACK);
                         playAttackSound();
@@ -559,17 +874,14 @@ void handleInput() {
             }
             
             if (impulseModeActive && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                Vector2 mousePos = GetMousePosition();
-                int gridX = (mousePos.x - gridOffsetX) / cellSize;
-                int gridY = (mousePos.y - gridOffsetY) / cellSize;
-                
-                if (gridX >= 0 && gridX < gridSize && gridY >= 0 && gridY < gridSize) {
+                int gridX, gridY;
+                if (screenToCell(GetMousePosition(), gridX, gridY)) {
                     handleImpulseCellSelection(gridX, gridY);
                 }
             }
             break;
             
-        case GameState::GAME_OVER:
+        case AppState::GAME_OVER:
             if (IsKeyPressed(KEY_M)) {
                 toggleMusic();
                 musicButtonActive = musicEnabled;
@@ -579,133 +891,162 @@ void handleInput() {
 }
 
 void processPlayerTurn() {
+    // a sealed-off player has nothing to click, so the turn passes by itself
+    if (!hasLegalMove(game, CellState::PLAYER)) {
+        playMove(Move::pass());
+        aiTimer = 0.0f;
+    }
 }
 
 void processAITurn(float deltaTime) {
+    PROFILE_ZONE("processAITurn");
+    if (!aiThread.joinable()) {
+        startAIThinking();
+    }
+    
     aiTimer += deltaTime;
+    if (aiTimer < AI_DELAY || !aiMoveReady.load(std::memory_order_acquire)) {
+        return;
+    }
     
-    if (aiTimer >= AI_DELAY) {
-        if (aiCharges >= impulseCost && decideAIImpulseMode() == ImpulseMode::ATTACK) {
-            auto attackCells = getAIAttackMove();
-            for (auto& cell : attackCells) {
-                if (cell.first != -1) {
-                    grid[cell.first][cell.second] = CellState::AI;
-                    playerCells--;
-                    aiCells++;
+    aiThread.join();
+    Move move = aiMove;
+    if (!applyLocalMove(move)) {
+        // searching the same position again would only find the same move
+        TraceLog(LOG_ERROR, "AI chose an illegal move; passing instead");
+        move = Move::pass();
+        applyLocalMove(move);
+    }
+    
+    const MctsStats& stats = aiAgent.lastStats();
+    TraceLog(LOG_INFO, "AI: %lld playouts in %.2fs (%.0f playouts/s, %lld nodes, %lld table hits)",
+             stats.playouts, stats.seconds, stats.playoutsPerSecond(), stats.nodes, stats.tableHits);
+    if (stats.tablebaseRejects > 0) {
+        TraceLog(LOG_WARNING, "AI: tablebase move was illegal here, searched instead");
+    }
+    
+    playMoveSound(move);
+}
+
+void pollServer() {
+    if (!server.poll(0)) {
+        TraceLog(LOG_WARNING, "lost the connection to the server");
+        onlineMatch = 0;
+        awaitingServer = false;
+        currentState = AppState::MENU;
+        return;
+    }
+    
+    ServerEvent event;
+    while (server.nextEvent(event)) {
+        switch (event.type) {
+            case MessageType::MATCH_STARTED:
+                onlineMatch = event.match;
+                awaitingServer = false;
+                break;
+            case MessageType::MOVE_PLAYED:
+                if (event.match != onlineMatch) break;
+                applyLocalMove(event.move);
+                if (event.side == CellState::PLAYER) {
+                    awaitingServer = false;
+                } else {
+                    playMoveSound(event.move);
                 }
-            }
-            if (!attackCells.empty()) {
-                aiCharges -= impulseCost;
-                PlaySound(attackSound);
-            }
-        } else if (aiCharges >= impulseCost && decideAIImpulseMode() == ImpulseMode::SPEED) {
-            auto cells = getAISpeedMove();
-            for (auto& cell : cells) {
-                if (cell.first != -1) {
-                    grid[cell.first][cell.second] = CellState::AI;
-                    aiCells++;
+                if (game.isOver()) {
+                    onlineMatch = 0;
                 }
-            }
-            if (!cells.empty()) {
-                aiCharges -= impulseCost;
-                PlaySound(impulseSound);
-            }
-        } else {
-            auto move = getAIMove();
-            if (move.first != -1) {
-                grid[move.first][move.second] = CellState::AI;
-                aiCells++;
-                aiCharges++;
-                PlaySound(captureSound);
-            }
+                break;
+            case MessageType::REJECTED:
+                if (event.match != onlineMatch) break;
+                TraceLog(LOG_WARNING, "server rejected the request (reason %d)", (int)event.reason);
+                awaitingServer = false;
+                if (onlineMatch == 0) {
+                    // the match itself was refused: nothing is waiting on the server
+                    TraceLog(LOG_WARNING, "server would not host the match, playing it locally");
+                    playingOnline = false;
+                    return;
+                }
+                if (event.reason == RejectReason::NO_SUCH_MATCH) {
+                    onlineMatch = 0;
+                }
+                break;
+            default:
+                break;
         }
-        
-        playerTurn = true;
-        checkWinCondition();
     }
 }
 
-void checkWinCondition() {
-    int totalCells = gridSize * gridSize;
-    int targetCells = (totalCells * WIN_PERCENTAGE + 99) / 100;
-    
-    bool playerWin = (playerCells >= targetCells);
-    bool aiWin = (aiCells >= targetCells);
-    
-    if (playerWin && aiWin) {
-        gameResult = GameResult::DRAW;
-    } else if (playerWin) {
-        gameResult = GameResult::PLAYER_WIN;
-    } else if (aiWin) {
-        gameResult = GameResult::AI_WIN;
+void leaveOnlineMatch() {
+    if (onlineMatch != 0) {
+        server.leaveMatch(onlineMatch);
+        onlineMatch = 0;
+    }
+    awaitingServer = false;
+}
+
+void startAIThinking() {
+    aiCancel.store(false);
+    aiMoveReady.store(false);
+    aiPosition = game;
+    aiThread = std::thread([] {
+        aiMove = aiAgent.chooseMove(aiPosition, rng);
+        TelemetrySample sample;
+        sample.event = TelemetryEvent::SEARCH;
+        sample.side = (uint8_t)aiPosition.toMove;
+        sample.turn = (uint32_t)aiPosition.turn;
+        sample.match = matchesStarted;
+        sample.value = (uint64_t)(aiAgent.lastStats().seconds * 1e9);
+        sample.count = (uint64_t)aiAgent.lastStats().nodes;
+        recordTelemetry(sample);
+        aiMoveReady.store(true, std::memory_order_release);
+    });
+}
+
+void cancelAIThinking() {
+    if (aiThread.joinable()) {
+        aiCancel.store(true);
+        aiThread.join();
     }
+    aiMoveReady.store(false);
 }
 
 void startImpulseMode(ImpulseMode mode) {
-    if (playerCharges >= impulseCost) {
+    if (canUseImpulse(game, CellState::PLAYER)) {
         impulseModeActive = true;
         currentImpulseMode = mode;
         selectedCells.clear();
+        selectedMask.clear();
     }
 }
 
 void handleImpulseCellSelection(int x, int y) {
-    if (currentImpulseMode == ImpulseMode::ATTACK) {
-        if (grid[x][y] == CellState::AI) {
-            auto adjacent = getAdjacentCells(x, y);
-            for (auto& adj : adjacent) {
-                if (grid[adj.first][adj.second] == CellState::PLAYER) {
-                    bool alreadySelected = false;
-                    for (auto& cell : selectedCells) {
-                        if (cell.first == x && cell.second == y) {
-                            alreadySelected = true;
-                            break;
-                        }
-                    }
-                    
-                    if (!alreadySelected && selectedCells.size() < 2) {
-                        selectedCells.push_back({x, y});
-                    }
-                    
-                    if (selectedCells.size() >= 2) {
-                        for (auto& cell : selectedCells) {
-                            grid[cell.first][cell.second] = CellState::PLAYER;
-                            aiCells--;
-                            playerCells++;
-                        }
-                        playerCharges -= impulseCost;
-                        finishImpulseMode();
-                        playerTurn = false;
-                        aiTimer = 0.0f;
-                    }
-                    return;
-                }
-            }
+    int cell = game.board.index(x, y);
+    bool attack = currentImpulseMode == ImpulseMode::ATTACK;
+    size_t needed = attack ? 2 : 3;
+    
+    bool selectable = attack ? isLegalAttackTarget(game, CellState::PLAYER, cell)
+                             : isLegalCapture(game, CellState::PLAYER, cell);
+    if (currentImpulseMode == ImpulseMode::NONE || !selectable) {
+        return;
+    }
+    
+    if (!selectedMask.test(cell) && selectedCells.size() < needed) {
+        selectedCells.push_back({x, y});
+        selectedMask.set(cell);
+    }
+    
+    if (selectedCells.size() >= needed) {
+        Move move;
+        move.type = attack ? MoveType::ATTACK : MoveType::SPEED;
+        move.count = static_cast<uint8_t>(selectedCells.size());
+        for (size_t i = 0; i < selectedCells.size(); i++) {
+            move.cells[i] = game.board.index(selectedCells[i].first, selectedCells[i].second);
         }
-    } else if (currentImpulseMode == ImpulseMode::SPEED) {
-        if (grid[x][y] == CellState::NEUTRAL && isValidMove(x, y, CellState::PLAYER)) {
-            bool alreadySelected = false;
-            for (auto& cell : selectedCells) {
-                if (cell.first == x && cell.second == y) {
-                    alreadySelected = true;
-                    break;
-                }
-            }
-            
-            if (!alreadySelected && selectedCells.size() < 3) {
-                selectedCells.push_back({x, y});
-            }
-            
-            if (selectedCells.size() >= 3) {
-                for (auto& cell : selectedCells) {
-                    grid[cell.first][cell.second] = CellState::PLAYER;
-                    playerCells++;
-                }
-                playerCharges -= impulseCost;
-                finishImpulseMode();
-                playerTurn = false;
-                aiTimer = 0.0f;
-            }
+        
+        bool applied = playMove(move);
+        finishImpulseMode();
+        if (applied) {
+            aiTimer = 0.0f;
         }
     }
 }
@@ -714,159 +1055,377 @@ void finishImpulseMode() {
     impulseModeActive = false;
     currentImpulseMode = ImpulseMode::NONE;
     selectedCells.clear();
+    selectedMask.clear();
 }
 
-std::vector<std::pair<int, int>> getAvailableMoves(CellState player) {
-    std::vector<std::pair<int, int>> moves;
-    
-    for (int x = 0; x < gridSize; x++) {
-        for (int y = 0; y < gridSize; y++) {
-            if (grid[x][y] == CellState::NEUTRAL) {
-                auto adjacent = getAdjacentCells(x, y);
-                for (auto& adj : adjacent) {
-                    if (grid[adj.first][adj.second] == player) {
-                        moves.push_back({x, y});
-                        break;
-                    }
-                }
-            }
-        }
+// The player's moves: applied here, or sent to the server when online.
+bool playMove(const Move& move) {
+    if (!playingOnline) {
+        return applyLocalMove(move);
     }
-    
-    return moves;
+    if (awaitingServer || onlineMatch == 0 || !isLegalMove(game, move)) {
+        return false;
+    }
+    server.playMove(onlineMatch, game.turn, move);
+    awaitingServer = true;
+    return true;
 }
 
-bool isValidMove(int x, int y, CellState player) {
-    if (x < 0 || x >= gridSize || y < 0 || y >= gridSize || grid[x][y] != CellState::NEUTRAL) {
+bool applyLocalMove(const Move& move) {
+    CellState mover = game.toMove;
+    int turn = game.turn;
+    if (!makeMove(game, move, history)) {
         return false;
     }
-    
-    auto adjacent = getAdjacentCells(x, y);
-    for (auto& adj : adjacent) {
-        if (grid[adj.first][adj.second] == player) {
-            return true;
-        }
+    recordMoveTelemetry(mover, turn, move);
+    if (replay.inGame()) {
+        replay.move(move);
+        replayLog.append(replay);
     }
-    
-    return false;
+    return true;
 }
 
-std::vector<std::pair<int, int>> getAdjacentCells(int x, int y) {
-    std::vector<std::pair<int, int>> adjacent;
-    
-    int dx[] = {-1, 1, 0, 0};
-    int dy[] = {0, 0, -1, 1};
+void recordMoveTelemetry(CellState mover, int turn, const Move& move) {
+    double now = GetTime();
+    TelemetrySample sample;
+    sample.event = TelemetryEvent::TURN;
+    sample.side = (uint8_t)mover;
+    sample.turn = (uint32_t)turn;
+    sample.match = matchesStarted;
+    sample.value = (uint64_t)((now - turnStartedAt) * 1e9);
+    recordTelemetry(sample);
+    turnStartedAt = now;
     
-    for (int i = 0; i < 4; i++) {
-        int nx = x + dx[i];
-        int ny = y + dy[i];
-        
-        if (nx >= 0 && nx < gridSize && ny >= 0 && ny < gridSize) {
-            adjacent.push_back({nx, ny});
-        }
+    if (move.type == MoveType::ATTACK || move.type == MoveType::SPEED) {
+        sample.event = TelemetryEvent::IMPULSE;
+        sample.value = 0;
+        sample.detail = (uint16_t)move.type;
+        sample.count = move.count;
+        recordTelemetry(sample);
+    }
+    if (game.isOver()) {
+        sample.event = TelemetryEvent::MATCH_END;
+        sample.detail = (uint16_t)game.outcome;
+        sample.count = 0;
+        recordTelemetry(sample);
     }
-    
-    return adjacent;
 }
 
-void renderCell(int x, int y, CellState state, bool isSelected) {
-    Color cellColor;
-    
+void playMoveSound(const Move& move) {
+    switch (move.type) {
+        case MoveType::ATTACK: playAttackSound(); break;
+        case MoveType::SPEED: playImpulseSound(); break;
+        case MoveType::CAPTURE: playCaptureSound(); break;
+        case MoveType::PASS: break;
+    }
+}
+
+// Takes back the AI's reply and the player's move before it, so the player is
+// to move again. Only called while the AI is not thinking.
+bool undoLastTurn() {
+    // the server's copy of an online match cannot be taken back
+    if (playingOnline || history.size() < 2 || history.back().toMove != CellState::AI) {
+        return false;
+    }
+    undoMove(game, history);
+    undoMove(game, history);
+    if (replay.inGame()) {
+        replay.undo();
+        replay.undo();
+        replayLog.append(replay);
+    }
+    aiTimer = 0.0f;
+    return true;
+}
+
+// Closes the match in the replay log with its outcome so far; abandoned
+// matches are kept, marked unfinished.
+void finishRecording() {
+    if (replay.inGame()) {
+        replay.endGame(game.outcome);
+        replayLog.append(replay);
+    }
+}
+
+Color cellColor(CellState state, bool isSelected) {
     switch (state) {
-        case CellState::NEUTRAL: cellColor = GRAY; break;
-        case CellState::PLAYER: cellColor = isSelected ? ColorAlpha(BLUE, 0.3f) : BLUE; break;
-        case CellState::AI: cellColor = isSelected ? ColorAlpha(RED, 0.3f) : RED; break;
+        case CellState::PLAYER: return isSelected ? ColorAlpha(BLUE, 0.3f) : BLUE;
+        case CellState::AI: return isSelected ? ColorAlpha(RED, 0.3f) : RED;
+        default: return GRAY;
     }
-    
-    if (impulseModeActive && !isSelected) {
-        cellColor = ColorAlpha(cellColor, 0.5f);
+}
+
+void rebuildBoardCache() {
+    releaseBoardCache();
+    if (boardRenderer.load(gridSize)) {
+        return;
     }
     
-    DrawRectangle(gridOffsetX + x * cellSize, gridOffsetY + y * cellSize,
-                 cellSize - 1, cellSize - 1, cellColor);
+    chunksPerSide = (gridSize + CHUNK_CELLS - 1) / CHUNK_CELLS;
+    boardChunks.assign(chunksPerSide * chunksPerSide, BoardChunk());
     
-    DrawRectangleLines(gridOffsetX + x * cellSize, gridOffsetY + y * cellSize,
-                      cellSize, cellSize, WHITE);
-    
-    if (playerTurn && !impulseModeActive && state == CellState::NEUTRAL && isValidMove(x, y, CellState::PLAYER)) {
-        DrawRectangleLines(gridOffsetX + x * cellSize + 2, gridOffsetY + y * cellSize + 2,
-                          cellSize - 4, cellSize - 4, YELLOW);
+    int chunkPixels = std::min(gridSize, CHUNK_CELLS) * cellSize;
+    chunkLines = LoadRenderTexture(chunkPixels, chunkPixels);
+    BeginTextureMode(chunkLines);
+    ClearBackground(BLANK);
+    if (cellSize > 2) {
+        for (int y = 0; y < std::min(gridSize, CHUNK_CELLS); y++) {
+            for (int x = 0; x < std::min(gridSize, CHUNK_CELLS); x++) {
+                DrawRectangleLines(x * cellSize, y * cellSize, cellSize, cellSize, WHITE);
+            }
+        }
     }
+    EndTextureMode();
+    
+    // no cell matches this, so every chunk paints fully the first time
+    cachedCells.assign(gridSize * gridSize, static_cast<CellState>(0xFF));
+    cachedRevision = game.board.revision() - 1;
+    boardCacheReady = true;
 }
 
-std::pair<int, int> getAIMove() {
-    auto availableMoves = getAvailableMoves(CellState::AI);
-    
-    if (availableMoves.empty()) {
-        return {-1, -1};
+void releaseBoardCache() {
+    boardRenderer.unload();
+    if (!boardCacheReady) {
+        return;
     }
+    for (BoardChunk& chunk : boardChunks) {
+        if (chunk.ready) {
+            UnloadRenderTexture(chunk.texture);
+        }
+    }
+    boardChunks.clear();
+    UnloadRenderTexture(chunkLines);
+    boardCacheReady = false;
+}
+
+void visibleChunks(int& firstX, int& firstY, int& lastX, int& lastY) {
+    Vector2 topLeft = GetScreenToWorld2D(Vector2{0, 0}, camera);
+    Vector2 bottomRight = GetScreenToWorld2D(Vector2{(float)WINDOW_WIDTH, (float)WINDOW_HEIGHT}, camera);
+    float chunkWorld = (float)CHUNK_CELLS * cellSize;
     
-    std::uniform_int_distribution<> dis(0, availableMoves.size() - 1);
-    return availableMoves[dis(rng)];
+    firstX = std::max(0, (int)std::floor(topLeft.x / chunkWorld));
+    firstY = std::max(0, (int)std::floor(topLeft.y / chunkWorld));
+    lastX = std::min(chunksPerSide - 1, (int)std::floor(bottomRight.x / chunkWorld));
+    lastY = std::min(chunksPerSide - 1, (int)std::floor(bottomRight.y / chunkWorld));
 }
 
-std::vector<std::pair<int, int>> getAIAttackMove() {
-    std::vector<std::pair<int, int>> attackableCells;
+void paintChunk(int chunk, bool changedOnly) {
+    PROFILE_ZONE("paintChunk");
+    int x0 = (chunk % chunksPerSide) * CHUNK_CELLS;
+    int y0 = (chunk / chunksPerSide) * CHUNK_CELLS;
+    int x1 = std::min(gridSize, x0 + CHUNK_CELLS);
+    int y1 = std::min(gridSize, y0 + CHUNK_CELLS);
+    const CellState* cells = game.board.data();
     
-    for (int x = 0; x < gridSize; x++) {
-        for (int y = 0; y < gridSize; y++) {
-            if (grid[x][y] == CellState::PLAYER) {
-                auto adjacent = getAdjacentCells(x, y);
-                for (auto& adj : adjacent) {
-                    if (grid[adj.first][adj.second] == CellState::AI) {
-                        attackableCells.push_back({x, y});
-                        break;
-                    }
+    if (changedOnly) {
+        bool changed = false;
+        for (int y = y0; y < y1 && !changed; y++) {
+            for (int x = x0; x < x1; x++) {
+                int i = game.board.index(x, y);
+                if (cachedCells[i] != cells[i]) {
+                    changed = true;
+                    break;
                 }
             }
         }
+        if (!changed) {
+            return;
+        }
     }
     
-    std::vector<std::pair<int, int>> result;
-    if (attackableCells.empty()) {
-        return result;
+    int fill = cellSize > 2 ? cellSize - 1 : cellSize;
+    BeginTextureMode(boardChunks[chunk].texture);
+    if (!changedOnly) {
+        ClearBackground(BLACK);
+    }
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int i = game.board.index(x, y);
+            if (!changedOnly || cachedCells[i] != cells[i]) {
+                DrawRectangle((x - x0) * cellSize, (y - y0) * cellSize, fill, fill, cellColor(cells[i], false));
+                cachedCells[i] = cells[i];
+            }
+        }
+    }
+    EndTextureMode();
+}
+
+// runs before BeginDrawing: texture mode would reset the camera transform
+void updateBoardCache() {
+    PROFILE_ZONE("updateBoardCache");
+    if (boardRenderer.loaded()) {
+        boardRenderer.update(game.board, selectedMask);
+        return;
+    }
+    if (!boardCacheReady) {
+        return;
     }
     
-    std::shuffle(attackableCells.begin(), attackableCells.end(), rng);
-    
-    if (attackableCells.size() >= 2) {
-        result.push_back(attackableCells[0]);
-        result.push_back(attackableCells[1]);
-    } else if (!attackableCells.empty()) {
-        result.push_back(attackableCells[0]);
+    int firstX, firstY, lastX, lastY;
+    visibleChunks(firstX, firstY, lastX, lastY);
+    for (int cy = firstY; cy <= lastY; cy++) {
+        for (int cx = firstX; cx <= lastX; cx++) {
+            BoardChunk& chunk = boardChunks[cy * chunksPerSide + cx];
+            if (!chunk.ready) {
+                int cellsX = std::min(CHUNK_CELLS, gridSize - cx * CHUNK_CELLS);
+                int cellsY = std::min(CHUNK_CELLS, gridSize - cy * CHUNK_CELLS);
+                chunk.texture = LoadRenderTexture(cellsX * cellSize, cellsY * cellSize);
+                chunk.ready = true;
+                paintChunk(cy * chunksPerSide + cx, false);
+            }
+        }
     }
     
-    return result;
+    if (cachedRevision == game.board.revision()) {
+        return;
+    }
+    for (int i = 0; i < (int)boardChunks.size(); i++) {
+        if (boardChunks[i].ready) {
+            paintChunk(i, true);
+        }
+    }
+    cachedRevision = game.board.revision();
 }
 
-std::vector<std::pair<int, int>> getAISpeedMove() {
-    auto availableMoves = getAvailableMoves(CellState::AI);
+void renderBoard() {
+    PROFILE_ZONE("renderBoard");
+    if (boardRenderer.loaded()) {
+        BeginMode2D(camera);
+        boardRenderer.draw(cellSize, impulseModeActive, game.toMove == CellState::PLAYER && !impulseModeActive);
+        EndMode2D();
+        return;
+    }
+    
+    int firstX, firstY, lastX, lastY;
+    visibleChunks(firstX, firstY, lastX, lastY);
+    float chunkWorld = (float)CHUNK_CELLS * cellSize;
     
-    std::vector<std::pair<int, int>> result;
+    BeginMode2D(camera);
     
-    if (availableMoves.empty()) {
-        return result;
+    // dimming by tint matches the old per-cell ColorAlpha(color, 0.5f) over black
+    Color tint = impulseModeActive ? Color{127, 127, 127, 255} : WHITE;
+    for (int cy = firstY; cy <= lastY; cy++) {
+        for (int cx = firstX; cx <= lastX; cx++) {
+            const BoardChunk& chunk = boardChunks[cy * chunksPerSide + cx];
+            if (!chunk.ready) {
+                continue;
+            }
+            // render textures are stored upside down
+            float width = (float)chunk.texture.texture.width;
+            float height = (float)chunk.texture.texture.height;
+            DrawTextureRec(chunk.texture.texture, Rectangle{0, 0, width, -height},
+                           Vector2{cx * chunkWorld, cy * chunkWorld}, tint);
+        }
     }
     
-    std::vector<std::pair<int, int>> moves = availableMoves;
-    std::shuffle(moves.begin(), moves.end(), rng);
+    int fill = cellSize > 2 ? cellSize - 1 : cellSize;
+    for (auto& cell : selectedCells) {
+        int x = cell.first * cellSize;
+        int y = cell.second * cellSize;
+        DrawRectangle(x, y, fill, fill, BLACK);
+        DrawRectangle(x, y, fill, fill, cellColor(game.board.at(cell.first, cell.second), true));
+    }
     
-    if (moves.size() >= 3) {
-        result.push_back(moves[0]);
-        result.push_back(moves[1]);
-        result.push_back(moves[2]);
-    } else if (moves.size() >= 2) {
-        result.push_back(moves[0]);
-        result.push_back(moves[1]);
-    } else if (!moves.empty()) {
-        result.push_back(moves[0]);
+    for (int cy = firstY; cy <= lastY; cy++) {
+        for (int cx = firstX; cx <= lastX; cx++) {
+            float width = (float)std::min(CHUNK_CELLS, gridSize - cx * CHUNK_CELLS) * cellSize;
+            float height = (float)std::min(CHUNK_CELLS, gridSize - cy * CHUNK_CELLS) * cellSize;
+            float top = chunkLines.texture.height - height;
+            DrawTextureRec(chunkLines.texture, Rectangle{0, top, width, -height},
+                           Vector2{cx * chunkWorld, cy * chunkWorld}, WHITE);
+        }
     }
     
-    return result;
+    if (game.toMove == CellState::PLAYER && !impulseModeActive) {
+        int minX = firstX * CHUNK_CELLS;
+        int minY = firstY * CHUNK_CELLS;
+        int maxX = (lastX + 1) * CHUNK_CELLS;
+        int maxY = (lastY + 1) * CHUNK_CELLS;
+        for (int cell : game.board.frontier(CellState::PLAYER)) {
+            int x = game.board.xOf(cell);
+            int y = game.board.yOf(cell);
+            if (x < minX || x >= maxX || y < minY || y >= maxY) {
+                continue;
+            }
+            if (cellSize > 4) {
+                DrawRectangleLines(x * cellSize + 2, y * cellSize + 2, cellSize - 4, cellSize - 4, YELLOW);
+            } else {
+                DrawRectangle(x * cellSize, y * cellSize, cellSize, cellSize, ColorAlpha(YELLOW, 0.6f));
+            }
+        }
+    }
+    
+    EndMode2D();
+}
+
+SceneStamp sceneStamp() {
+    SceneStamp stamp;
+    stamp.state = currentState;
+    stamp.revision = game.board.revision();
+    stamp.turn = game.turn;
+    stamp.impulseMode = impulseModeActive;
+    stamp.selected = selectedCells.size();
+    stamp.music = musicEnabled;
+    stamp.awaitingServer = awaitingServer;
+    stamp.camera = camera;
+    return stamp;
 }
 
-ImpulseMode decideAIImpulseMode() {
-    std::uniform_real_distribution<> dis(0.0, 1.0);
-    return (dis(rng) < 0.5) ? ImpulseMode::ATTACK : ImpulseMode::SPEED;
+bool sceneChanged(const SceneStamp& a, const SceneStamp& b) {
+    return a.state != b.state || a.revision != b.revision || a.turn != b.turn ||
+           a.impulseMode != b.impulseMode || a.selected != b.selected || a.music != b.music ||
+           a.awaitingServer != b.awaitingServer || a.camera.zoom != b.camera.zoom ||
+           a.camera.target.x != b.camera.target.x || a.camera.target.y != b.camera.target.y ||
+           a.camera.offset.x != b.camera.offset.x || a.camera.offset.y != b.camera.offset.y;
+}
+
+// Anything since the last poll that could change what is drawn, hover
+// highlights included; menu clicks and key presses then act on the frame
+// drawn because of them.
+bool inputArrived() {
+    Vector2 delta = GetMouseDelta();
+    if (delta.x != 0.0f || delta.y != 0.0f || GetMouseWheelMove() != 0.0f) return true;
+    for (int button = MOUSE_BUTTON_LEFT; button <= MOUSE_BUTTON_MIDDLE; button++) {
+        if (IsMouseButtonDown(button) || IsMouseButtonReleased(button)) return true;
+    }
+    if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_UP) || IsKeyDown(KEY_DOWN)) return true;
+    return GetKeyPressed() != 0 || IsWindowResized();
+}
 
+// F3: rolling frame-time histogram, p50/p99 and the average cost of each
+// profiler zone. Only present in TERRA_PROFILE builds.
+void renderProfilerOverlay() {
+#if defined(TERRA_PROFILE)
+    if (!profilerOverlay) {
+        return;
+    }
+    
+    const Profiler& profiler = Profiler::instance();
+    const int x = 10;
+    const int y = 90;
+    const int graphHeight = 60;
+    const float msPerPixel = 50.0f / graphHeight;
+    int width = Profiler::HISTORY + 20;
+    int height = graphHeight + 40 + 16 * profiler.zones();
+    
+    DrawRectangle(x, y, width, height, Fade(BLACK, 0.8f));
+    
+    int baseline = y + 10 + graphHeight;
+    for (int i = 0; i < profiler.frameCount(); i++) {
+        float ms = (float)(profiler.frame(i) * 1000.0);
+        int bar = std::min(graphHeight, (int)(ms / msPerPixel));
+        Color color = ms > 33.4f ? RED : ms > 16.8f ? YELLOW : GREEN;
+        DrawLine(x + 10 + i, baseline, x + 10 + i, baseline - bar, color);
+    }
+    int budget = baseline - (int)(16.7f / msPerPixel);
+    DrawLine(x + 10, budget, x + 10 + Profiler::HISTORY, budget, Fade(WHITE, 0.5f));
+    
+    DrawText(TextFormat("frame p50 %.1f ms  p99 %.1f ms", profiler.frameQuantile(0.5) * 1000.0,
+                        profiler.frameQuantile(0.99) * 1000.0),
+             x + 10, baseline + 6, 10, WHITE);
+    for (int zone = 0; zone < profiler.zones(); zone++) {
+        DrawText(TextFormat("%-18s %6.2f ms", profiler.zoneName(zone), profiler.zoneAverage(zone) * 1000.0),
+                 x + 10, baseline + 24 + 16 * zone, 10, LIGHTGRAY);
+    }
+#endif
 }
@@ -0,0 +1,327 @@
+#include "mcts.h"
+
+#include "arena.h"
+#include "bitboard.h"
+#include "fixed_board.h"
+#include "tablebase.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+const int CLOCK_CHECK_INTERVAL = 16;
+const int MAX_PLAYOUT_TURNS = 512;
+const uint32_t MAX_PRIOR_VISITS = 32;     // caps how much a table hit outweighs fresh playouts
+
+struct Node {
+    Move move;
+    int parent = -1;
+    int firstChild = -1;
+    int childCount = 0;
+    int visits = 0;
+    double reward = 0.0;           // summed from the point of view of mover
+    CellState mover = CellState::PLAYER;
+    uint64_t hash = 0;             // Zobrist key of the position after move
+};
+
+// Tree and scratch lists live in the searching thread's arena, so searches
+// after the first on a thread allocate nothing.
+using NodeList = ArenaVector<Node>;
+using ActionList = ArenaVector<Move>;
+
+bool sameTargets(const Move& a, const Move& b) {
+    if (a.type != b.type || a.count != b.count) return false;
+    for (int i = 0; i < a.count; i++) {
+        if (std::find(b.cells, b.cells + b.count, a.cells[i]) == b.cells + b.count) return false;
+    }
+    return true;
+}
+
+// Game is BitGame or a FixedGame<N>; both expose the same target queries.
+template <typename Game>
+void addImpulses(const Game& state, MoveType type, int size, int samples,
+                 std::mt19937& rng, ActionList& actions) {
+    int available = state.targetCount(type);
+    if (available == 0) return;
+
+    Move move;
+    move.type = type;
+    if (available <= size) {
+        move.count = static_cast<uint8_t>(available);
+        int i = 0;
+        state.forEachTarget(type, [&](int cell) { move.cells[i++] = cell; });
+        actions.push_back(move);
+        return;
+    }
+
+    int first = actions.size();
+    for (int s = 0; s < samples; s++) {
+        move.count = static_cast<uint8_t>(state.sampleTargets(type, size, move.cells, rng));
+        bool duplicate = false;
+        for (int i = first; i < actions.size() && !duplicate; i++) {
+            duplicate = sameTargets(actions[i], move);
+        }
+        if (!duplicate) actions.push_back(move);
+    }
+}
+
+template <typename Game>
+void generateActions(const Game& state, int impulseSamples, std::mt19937& rng, ActionList& actions) {
+    actions.clear();
+    state.forEachTarget(MoveType::CAPTURE, [&](int cell) { actions.push_back(Move::capture(cell)); });
+    if (state.canUseImpulse(state.toMove)) {
+        addImpulses(state, MoveType::ATTACK, 2, impulseSamples, rng, actions);
+        addImpulses(state, MoveType::SPEED, 3, impulseSamples, rng, actions);
+    }
+    if (actions.empty()) {
+        actions.push_back(Move::pass());
+    }
+}
+
+template <typename Game>
+double rewardFor(const Game& state, CellState side) {
+    switch (state.outcome) {
+        case GameResult::PLAYER_WIN: return side == CellState::PLAYER ? 1.0 : 0.0;
+        case GameResult::AI_WIN: return side == CellState::AI ? 1.0 : 0.0;
+        case GameResult::DRAW: return 0.5;
+        case GameResult::NONE: break;
+    }
+
+    // unfinished playout: score the cell lead
+    int lead = state.cells(side) - state.cells(opponentOf(side));
+    if (lead > 0) return 1.0;
+    if (lead < 0) return 0.0;
+    return 0.5;
+}
+
+int selectChild(const NodeList& nodes, int node, double exploration) {
+    const Node& parent = nodes[node];
+    double logVisits = std::log(static_cast<double>(std::max(1, parent.visits)));
+    int best = parent.firstChild;
+    double bestScore = -1.0;
+
+    for (int i = 0; i < parent.childCount; i++) {
+        int child = parent.firstChild + i;
+        const Node& candidate = nodes[child];
+        if (candidate.visits == 0) return child;
+
+        double score = candidate.reward / candidate.visits +
+                       exploration * std::sqrt(logVisits / candidate.visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = child;
+        }
+    }
+    return best;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// The root's actions and their visit counts after one tree's search.
+struct RootVisits {
+    std::vector<Move> moves;
+    std::vector<int> visits;
+    MctsStats stats;
+};
+
+// Grows one tree until deadline or maxIterations and reports its root. Trees
+// searched in parallel share only config.table.
+template <typename Game>
+void searchTree(const GameState& root, const MctsConfig& config, long long maxIterations,
+                Clock::time_point deadline, std::mt19937& rng, RootVisits& result) {
+    int playoutTurnLimit = config.playoutTurnLimit > 0 ? config.playoutTurnLimit
+                                                       : std::min(2 * root.board.cellCount(), MAX_PLAYOUT_TURNS);
+
+    MctsStats counters;
+    ArenaScope scope(threadArena());
+    ActionList actions(threadArena());
+    NodeList nodes(threadArena(), 4096);
+
+    Node rootNode;
+    rootNode.mover = opponentOf(root.toMove);
+    nodes.push_back(rootNode);
+
+    // the tree is walked on bitboards too: copying one each iteration is a few
+    // words per row, where a GameState drags its neighbour sets along
+    Game origin;
+    origin.load(root);
+    Game scratch;
+    TranspositionTable* table = config.table;
+    TableEntry entry;
+    thread_local CandidateBatch frontier;
+    thread_local CandidateBatch contested;
+    std::uniform_real_distribution<> unit(0.0, 1.0);
+    auto forEachTarget = [&](MoveType type, auto&& fn) { scratch.forEachTarget(type, fn); };
+    bool timeLeft = true;
+    nodes[0].hash = origin.hash();
+
+    while (timeLeft) {
+        scratch = origin;
+        int node = 0;
+
+        // selection and expansion
+        while (!scratch.isOver()) {
+            if (nodes[node].childCount == 0) {
+                if (node != 0 && nodes[node].visits == 0) break;
+                generateActions(scratch, config.impulseSamples, rng, actions);
+                nodes[node].firstChild = nodes.size();
+                nodes[node].childCount = actions.size();
+                for (int a = 0; a < actions.size(); a++) {
+                    const Move& action = actions[a];
+                    Node child;
+                    child.move = action;
+                    child.parent = node;
+                    child.mover = scratch.toMove;
+                    if (table) {
+                        child.hash = scratch.hashAfter(action);
+                        if (table->probe(child.hash, entry)) {
+                            child.visits = static_cast<int>(std::min(entry.visits, MAX_PRIOR_VISITS));
+                            child.reward = entry.value * child.visits;
+                            counters.tableHits++;
+                        }
+                    }
+                    nodes.push_back(child);
+                }
+            }
+
+            node = selectChild(nodes, node, config.exploration);
+            scratch.applyMove(nodes[node].move);
+            if (nodes[node].visits == 0) break;
+        }
+
+        // playout
+        if (!scratch.isOver()) {
+            while (!scratch.isOver() && scratch.turn < root.turn + playoutTurnLimit) {
+                if (config.greedyPlayouts > 0.0 && unit(rng) < config.greedyPlayouts) {
+                    scratch.applyMove(chooseScoredMove(scratch.board, scratch.toMove, scratch.canUseImpulse(scratch.toMove),
+                                                       forEachTarget, config.playoutWeights, frontier, contested));
+                } else {
+                    scratch.playRandomMove(rng);
+                }
+                counters.playoutMoves++;
+            }
+            counters.playouts++;
+        }
+
+        // backpropagation
+        for (int n = node; n >= 0; n = nodes[n].parent) {
+            Node& path = nodes[n];
+            path.visits++;
+            path.reward += rewardFor(scratch, path.mover);
+            if (table) {
+                entry.visits = static_cast<uint32_t>(path.visits);
+                entry.value = static_cast<float>(path.reward / path.visits);
+                table->store(path.hash, entry);
+            }
+        }
+
+        counters.iterations++;
+        if (maxIterations > 0 && counters.iterations >= maxIterations) {
+            timeLeft = false;
+        } else if (counters.iterations % CLOCK_CHECK_INTERVAL == 0) {
+            bool cancelled = config.cancel && config.cancel->load(std::memory_order_relaxed);
+            timeLeft = !cancelled && Clock::now() < deadline;
+        }
+    }
+
+    const Node& top = nodes[0];
+    result.moves.clear();
+    result.visits.clear();
+    for (int i = 0; i < top.childCount; i++) {
+        const Node& child = nodes[top.firstChild + i];
+        result.moves.push_back(child.move);
+        result.visits.push_back(child.visits);
+    }
+    counters.nodes = static_cast<long long>(nodes.size());
+    result.stats = counters;
+}
+
+// Root parallelisation: independent trees, one per task, each with its own
+// RNG, that meet only through the transposition table. Their root visits are
+// summed per action; an impulse sampled by just one tree counts only there.
+template <typename Game>
+Move searchTrees(const GameState& root, const MctsConfig& config, std::mt19937& rng, MctsStats* stats) {
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config.timeBudget));
+    // the shared pool is only started by a search that asks for threads
+    ThreadPool* pool = config.pool;
+    if (!pool && config.threads != 1) pool = &sharedPool();
+    int trees = config.threads > 0 ? config.threads : pool->concurrency();
+    long long iterationsEach = config.maxIterations > 0 ? (config.maxIterations + trees - 1) / trees : 0;
+
+    std::vector<RootVisits> results(static_cast<size_t>(trees));
+    if (trees == 1) {
+        searchTree<Game>(root, config, iterationsEach, deadline, rng, results[0]);
+    } else {
+        std::vector<uint32_t> seeds(static_cast<size_t>(trees));
+        for (uint32_t& seed : seeds) seed = static_cast<uint32_t>(rng());
+        // a tree that only starts once the deadline has passed, because the
+        // pool was busy, stops after its first few iterations
+        pool->parallelFor(trees, [&](int tree) {
+            std::mt19937 treeRng(seeds[static_cast<size_t>(tree)]);
+            searchTree<Game>(root, config, iterationsEach, deadline, treeRng, results[static_cast<size_t>(tree)]);
+        });
+    }
+
+    RootVisits& merged = results[0];
+    for (size_t tree = 1; tree < results.size(); tree++) {
+        const RootVisits& other = results[tree];
+        for (size_t i = 0; i < other.moves.size(); i++) {
+            size_t slot = 0;
+            while (slot < merged.moves.size() && !sameTargets(merged.moves[slot], other.moves[i])) slot++;
+            if (slot == merged.moves.size()) {
+                merged.moves.push_back(other.moves[i]);
+                merged.visits.push_back(0);
+            }
+            merged.visits[slot] += other.visits[i];
+        }
+        merged.stats.iterations += other.stats.iterations;
+        merged.stats.playouts += other.stats.playouts;
+        merged.stats.playoutMoves += other.stats.playoutMoves;
+        merged.stats.nodes += other.stats.nodes;
+        merged.stats.tableHits += other.stats.tableHits;
+    }
+
+    Move best = Move::pass();
+    int bestVisits = -1;
+    for (size_t i = 0; i < merged.moves.size(); i++) {
+        if (merged.visits[i] > bestVisits) {
+            bestVisits = merged.visits[i];
+            best = merged.moves[i];
+        }
+    }
+
+    if (stats) {
+        *stats = merged.stats;
+        stats->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return best;
+}
+
+}
+
+Move searchMcts(const GameState& root, const MctsConfig& config, std::mt19937& rng, MctsStats* stats) {
+    SolvedPosition solved;
+    bool rejected = false;
+    if (config.tablebase && config.tablebase->probe(root, solved)) {
+        if (isLegalMove(root, solved.best)) {
+            if (stats) *stats = MctsStats();
+            return solved.best;
+        }
+        // probes match only part of the key, so this was another position's entry
+        rejected = true;
+    }
+
+    // standard menu sizes get boards specialised at compile time
+    Move best;
+    switch (root.rules.gridSize) {
+        case 7: best = searchTrees<FixedGame<7>>(root, config, rng, stats); break;
+        case 10: best = searchTrees<FixedGame<10>>(root, config, rng, stats); break;
+        case 12: best = searchTrees<FixedGame<12>>(root, config, rng, stats); break;
+        default: best = searchTrees<BitGame>(root, config, rng, stats); break;
+    }
+    if (stats && rejected) stats->tablebaseRejects = 1;
+    return best;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "agent.h"
+#include "evaluator.h"
+#include "rules.h"
+#include "transposition.h"
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+
+class Tablebase;
+class ThreadPool;
+
+const double DEFAULT_THINK_TIME = 1.0;
+
+struct MctsConfig {
+    double timeBudget = DEFAULT_THINK_TIME;  // wall-clock seconds per move
+    long long maxIterations = 0;             // 0 = until the budget runs out
+    double exploration = 1.4;
+    int impulseSamples = 8;                   // attack pairs and speed triples tried per node
+    int playoutTurnLimit = 0;                 // 0 = two turns per cell, at most 512
+    double greedyPlayouts = 0.0;              // share of playout moves the evaluator picks, the rest random
+    EvalWeights playoutWeights;
+    const std::atomic<bool>* cancel = nullptr; // stops the search early when set
+    TranspositionTable* table = nullptr;       // shared between searches and threads
+    int threads = 1;                          // root-parallel trees, 0 = one per pool thread
+    ThreadPool* pool = nullptr;               // runs the trees; nullptr = sharedPool()
+    const Tablebase* tablebase = nullptr;     // solved endgames, played without searching
+};
+
+struct MctsStats {
+    long long iterations = 0;
+    long long playouts = 0;
+    long long playoutMoves = 0;
+    long long nodes = 0;
+    long long tableHits = 0;                  // new nodes seeded from the table
+    long long tablebaseRejects = 0;           // tablebase moves illegal here, searched instead
+    double seconds = 0.0;
+
+    double playoutsPerSecond() const { return seconds > 0 ? playouts / seconds : 0.0; }
+    double playoutMovesPerSecond() const { return seconds > 0 ? playoutMoves / seconds : 0.0; }
+};
+
+// UCT search over captures, attack pairs and speed triples for state.toMove.
+// Impulses are sampled rather than enumerated so the branching factor stays
+// bounded on large boards. Always returns a legal move: the most visited root
+// action found before the budget ran out or config.cancel was raised.
+//
+// With config.table set, every node on a playout's path is written back under
+// its Zobrist key, and new nodes start from the stored statistics of the same
+// position reached by another move order or in an earlier search.
+//
+// With config.threads above one, that many trees are grown at once on the
+// pool, sharing the table, and the move is picked from their summed root
+// visits. maxIterations is then split between the trees.
+//
+// A position config.tablebase has solved is answered from it at once.
+Move searchMcts(const GameState& root, const MctsConfig& config, std::mt19937& rng, MctsStats* stats = nullptr);
+
+class MctsAgent : public Agent {
+public:
+    explicit MctsAgent(const MctsConfig& config = MctsConfig()) : config(config) {}
+
+    // Without a table in the config, the agent keeps one of its own across moves.
+    Move chooseMove(const GameState& state, std::mt19937& rng) override {
+        MctsConfig search = config;
+        if (!search.table) {
+            if (!ownTable) ownTable.reset(new TranspositionTable());
+            search.table = ownTable.get();
+        }
+        Move move = searchMcts(state, search, rng, &stats);
+        totalNodes += stats.nodes;
+        return move;
+    }
+
+    long long nodesSearched() const override { return totalNodes; }
+    const MctsStats& lastStats() const { return stats; }
+
+private:
+    MctsConfig config;
+    MctsStats stats;
+    long long totalNodes = 0;
+    std::unique_ptr<TranspositionTable> ownTable;
+};
@@ -0,0 +1,218 @@
+#include "net.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+namespace {
+
+using PollFd = WSAPOLLFD;
+
+bool setNonBlocking(Socket socket) {
+    u_long enabled = 1;
+    return ioctlsocket(static_cast<SOCKET>(socket), FIONBIO, &enabled) == 0;
+}
+
+bool wouldBlock() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+int pollFds(PollFd* fds, size_t count, int timeoutMs) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+
+}
+
+bool netStartup() {
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+}
+
+void netShutdown() {
+    WSACleanup();
+}
+
+void closeSocket(Socket socket) {
+    closesocket(static_cast<SOCKET>(socket));
+}
+
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+using PollFd = pollfd;
+
+bool setNonBlocking(Socket socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+int pollFds(PollFd* fds, size_t count, int timeoutMs) {
+    return poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+
+}
+
+bool netStartup() {
+    // a peer closing mid-send must not kill the process
+    signal(SIGPIPE, SIG_IGN);
+    return true;
+}
+
+void netShutdown() {
+}
+
+void closeSocket(Socket socket) {
+    close(socket);
+}
+
+#endif
+
+namespace {
+
+// Moves are a few bytes each and need acknowledging at once.
+void setNoDelay(Socket socket) {
+    int enabled = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enabled), sizeof(enabled));
+}
+
+}
+
+Socket listenOn(uint16_t port, int backlog) {
+    Socket listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET_HANDLE) return INVALID_SOCKET_HANDLE;
+
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, backlog) != 0 || !setNonBlocking(listener)) {
+        closeSocket(listener);
+        return INVALID_SOCKET_HANDLE;
+    }
+    return listener;
+}
+
+Socket acceptClient(Socket listener) {
+    Socket client = accept(listener, nullptr, nullptr);
+    if (client == INVALID_SOCKET_HANDLE) return INVALID_SOCKET_HANDLE;
+    if (!setNonBlocking(client)) {
+        closeSocket(client);
+        return INVALID_SOCKET_HANDLE;
+    }
+    setNoDelay(client);
+    return client;
+}
+
+Socket connectTo(const char* host, uint16_t port) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    char service[8];
+    std::snprintf(service, sizeof(service), "%u", static_cast<unsigned>(port));
+    if (getaddrinfo(host, service, &hints, &found) != 0) return INVALID_SOCKET_HANDLE;
+
+    Socket connected = INVALID_SOCKET_HANDLE;
+    for (addrinfo* entry = found; entry && connected == INVALID_SOCKET_HANDLE; entry = entry->ai_next) {
+        Socket candidate = ::socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+        if (candidate == INVALID_SOCKET_HANDLE) continue;
+        if (connect(candidate, entry->ai_addr, static_cast<int>(entry->ai_addrlen)) == 0 && setNonBlocking(candidate)) {
+            connected = candidate;
+        } else {
+            closeSocket(candidate);
+        }
+    }
+    freeaddrinfo(found);
+    if (connected != INVALID_SOCKET_HANDLE) setNoDelay(connected);
+    return connected;
+}
+
+bool socketPair(Socket out[2]) {
+#if defined(_WIN32)
+    // no socketpair(): connect two ends through a loopback listener
+    Socket listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET_HANDLE) return false;
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int length = sizeof(address);
+    bool ok = bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+              getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0 &&
+              listen(listener, 1) == 0;
+    out[0] = ok ? ::socket(AF_INET, SOCK_STREAM, 0) : INVALID_SOCKET_HANDLE;
+    ok = ok && out[0] != INVALID_SOCKET_HANDLE &&
+         connect(out[0], reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    out[1] = ok ? accept(listener, nullptr, nullptr) : INVALID_SOCKET_HANDLE;
+    closeSocket(listener);
+    ok = ok && out[1] != INVALID_SOCKET_HANDLE;
+#else
+    int fds[2];
+    bool ok = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0;
+    out[0] = ok ? fds[0] : INVALID_SOCKET_HANDLE;
+    out[1] = ok ? fds[1] : INVALID_SOCKET_HANDLE;
+#endif
+    ok = ok && setNonBlocking(out[0]) && setNonBlocking(out[1]);
+    if (!ok) {
+        if (out[0] != INVALID_SOCKET_HANDLE) closeSocket(out[0]);
+        if (out[1] != INVALID_SOCKET_HANDLE) closeSocket(out[1]);
+    }
+    return ok;
+}
+
+long long sendSome(Socket socket, const uint8_t* data, size_t size) {
+    long long sent = ::send(socket, reinterpret_cast<const char*>(data), static_cast<int>(size), 0);
+    if (sent >= 0) return sent;
+    return wouldBlock() ? 0 : -1;
+}
+
+long long receiveSome(Socket socket, uint8_t* data, size_t size) {
+    long long received = ::recv(socket, reinterpret_cast<char*>(data), static_cast<int>(size), 0);
+    if (received > 0) return received;
+    if (received == 0) return -1;
+    return wouldBlock() ? 0 : -1;
+}
+
+int pollSockets(PollEntry* entries, size_t count, int timeoutMs) {
+    static thread_local std::vector<PollFd> fds;
+    fds.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        fds[i].fd = entries[i].socket;
+        fds[i].events = static_cast<short>(POLLIN | (entries[i].wantWrite ? POLLOUT : 0));
+        fds[i].revents = 0;
+    }
+    int ready = pollFds(fds.data(), count, timeoutMs);
+    for (size_t i = 0; i < count; i++) {
+        short events = ready > 0 ? fds[i].revents : 0;
+        entries[i].readable = (events & POLLIN) != 0;
+        entries[i].writable = (events & POLLOUT) != 0;
+        entries[i].failed = (events & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+    }
+    return ready;
+}
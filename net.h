@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Thin layer over BSD sockets and Winsock: just what terra_server and the
+// client's network play need. Every socket it hands out is non-blocking.
+
+#if defined(_WIN32)
+using Socket = uintptr_t;
+constexpr Socket INVALID_SOCKET_HANDLE = ~Socket(0);
+#else
+using Socket = int;
+constexpr Socket INVALID_SOCKET_HANDLE = -1;
+#endif
+
+// Winsock needs starting once per process; elsewhere these do nothing.
+bool netStartup();
+void netShutdown();
+
+Socket listenOn(uint16_t port, int backlog = 1024);
+// Accepts one pending connection, INVALID_SOCKET_HANDLE if none is waiting.
+Socket acceptClient(Socket listener);
+// Blocking connect to host:port, then switched to non-blocking.
+Socket connectTo(const char* host, uint16_t port);
+// Two connected sockets, used to wake a poll() from another thread.
+bool socketPair(Socket out[2]);
+void closeSocket(Socket socket);
+
+// Bytes moved, 0 if the call would block, -1 if the connection is gone.
+long long sendSome(Socket socket, const uint8_t* data, size_t size);
+long long receiveSome(Socket socket, uint8_t* data, size_t size);
+
+struct PollEntry {
+    Socket socket;
+    bool wantWrite;
+    bool readable;
+    bool writable;
+    bool failed;
+};
+
+// Waits up to timeoutMs (-1 = forever) for any entry to become ready and fills
+// in readable, writable and failed. Returns the number of ready entries.
+int pollSockets(PollEntry* entries, size_t count, int timeoutMs);
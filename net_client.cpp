@@ -0,0 +1,145 @@
+#include "net_client.h"
+
+bool NetClient::connect(const char* host, uint16_t port) {
+    disconnect();
+    if (!netStartup()) return false;
+    socket = connectTo(host, port);
+    return connected();
+}
+
+void NetClient::disconnect() {
+    if (!connected()) return;
+    closeSocket(socket);
+    socket = INVALID_SOCKET_HANDLE;
+    input.clear();
+    output.clear();
+    events.clear();
+    netShutdown();
+}
+
+void NetClient::createMatch(const Rules& rules, int aiThinkMs) {
+    MessageWriter out(output);
+    out.begin(MessageType::CREATE_MATCH);
+    out.putRules(rules);
+    out.put(static_cast<uint64_t>(aiThinkMs));
+    out.end();
+}
+
+void NetClient::joinMatch(uint64_t match) {
+    MessageWriter out(output);
+    out.begin(MessageType::JOIN_MATCH);
+    out.put(match);
+    out.end();
+}
+
+void NetClient::playMove(uint64_t match, int turn, const Move& move) {
+    MessageWriter out(output);
+    out.begin(MessageType::PLAY_MOVE);
+    out.put(match);
+    out.put(static_cast<uint64_t>(turn));
+    out.putMove(move);
+    out.end();
+}
+
+void NetClient::leaveMatch(uint64_t match) {
+    MessageWriter out(output);
+    out.begin(MessageType::LEAVE_MATCH);
+    out.put(match);
+    out.end();
+}
+
+bool NetClient::flush() {
+    size_t sent = 0;
+    while (sent < output.size()) {
+        long long bytes = sendSome(socket, output.data() + sent, output.size() - sent);
+        if (bytes < 0) return false;
+        if (bytes == 0) break;
+        sent += static_cast<size_t>(bytes);
+    }
+    output.erase(output.begin(), output.begin() + static_cast<std::ptrdiff_t>(sent));
+    return true;
+}
+
+bool NetClient::poll(int timeoutMs) {
+    if (!connected()) return false;
+    if (!flush()) {
+        disconnect();
+        return false;
+    }
+
+    PollEntry entry{socket, !output.empty(), false, false, false};
+    pollSockets(&entry, 1, timeoutMs);
+    if (entry.writable && !flush()) {
+        disconnect();
+        return false;
+    }
+    if (!entry.readable && !entry.failed) return true;
+    uint8_t chunk[4096];
+    while (true) {
+        long long received = receiveSome(socket, chunk, sizeof(chunk));
+        if (received < 0) {
+            disconnect();
+            return false;
+        }
+        if (received == 0) break;
+        input.insert(input.end(), chunk, chunk + received);
+    }
+
+    size_t offset = 0;
+    while (true) {
+        const uint8_t* payload = nullptr;
+        size_t size = 0;
+        long long frame = nextFrame(input.data() + offset, input.size() - offset, payload, size);
+        if (frame < 0 || (frame > 0 && !decode(payload, size))) {
+            disconnect();
+            return false;
+        }
+        if (frame == 0) break;
+        offset += static_cast<size_t>(frame);
+    }
+    input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
+    return true;
+}
+
+bool NetClient::nextEvent(ServerEvent& event) {
+    if (events.empty()) return false;
+    event = std::move(events.front());
+    events.pop_front();
+    return true;
+}
+
+bool NetClient::decode(const uint8_t* payload, size_t size) {
+    MessageReader message(payload, size);
+    ServerEvent event;
+    event.type = message.type();
+    int side = 0;
+    int outcome = 0;
+    int reason = 0;
+    switch (event.type) {
+        case MessageType::MATCH_STARTED:
+            if (!message.get(event.match) || !message.getInt(side) || !message.getRules(event.rules)) return false;
+            event.side = static_cast<CellState>(side);
+            matchRules = event.rules;
+            break;
+        case MessageType::STATE:
+            event.state.rules = matchRules;
+            if (!message.get(event.match) || !message.getState(event.state)) return false;
+            break;
+        case MessageType::MOVE_PLAYED:
+            if (!message.get(event.match) || !message.getInt(event.turn) || !message.getInt(side) ||
+                !message.getMove(event.move) || !message.getInt(outcome)) {
+                return false;
+            }
+            event.side = static_cast<CellState>(side);
+            event.outcome = static_cast<GameResult>(outcome);
+            break;
+        case MessageType::REJECTED:
+            if (!message.get(event.match) || !message.getInt(reason)) return false;
+            event.reason = static_cast<RejectReason>(reason);
+            break;
+        default:
+            return false;
+    }
+    events.push_back(std::move(event));
+    return true;
+}
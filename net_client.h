@@ -0,0 +1,55 @@
+#pragma once
+
+#include "net.h"
+#include "protocol.h"
+#include <deque>
+#include <vector>
+
+// What the server said, decoded. Only the fields of the message's type are set.
+struct ServerEvent {
+    MessageType type = MessageType::REJECTED;
+    uint64_t match = 0;
+    CellState side = CellState::NEUTRAL;  // MATCH_STARTED: our side; MOVE_PLAYED: the mover
+    Rules rules;                          // MATCH_STARTED
+    GameState state;                      // STATE
+    int turn = 0;                         // MOVE_PLAYED
+    Move move;                            // MOVE_PLAYED
+    GameResult outcome = GameResult::NONE;
+    RejectReason reason = RejectReason::BAD_MESSAGE;
+};
+
+// One connection to a terra_server. Requests are queued and go out on the
+// next poll(), which also decodes whatever has arrived; nothing here blocks
+// except connect().
+class NetClient {
+public:
+    NetClient() = default;
+    NetClient(const NetClient&) = delete;
+    NetClient& operator=(const NetClient&) = delete;
+    ~NetClient() { disconnect(); }
+
+    bool connect(const char* host, uint16_t port);
+    void disconnect();
+    bool connected() const { return socket != INVALID_SOCKET_HANDLE; }
+
+    // aiThinkMs 0 leaves the second seat for another client to JOIN.
+    void createMatch(const Rules& rules, int aiThinkMs);
+    void joinMatch(uint64_t match);
+    void playMove(uint64_t match, int turn, const Move& move);
+    void leaveMatch(uint64_t match);
+
+    // Sends queued requests and reads replies, waiting up to timeoutMs for
+    // something to arrive. False once the connection is gone.
+    bool poll(int timeoutMs = 0);
+    bool nextEvent(ServerEvent& event);
+
+private:
+    bool flush();
+    bool decode(const uint8_t* payload, size_t size);
+
+    Socket socket = INVALID_SOCKET_HANDLE;
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+    std::deque<ServerEvent> events;
+    Rules matchRules;  // of the last MATCH_STARTED, for decoding STATE
+};
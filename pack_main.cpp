@@ -0,0 +1,76 @@
+#include "asset_bundle.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::printf("usage: %s [options] FILE...\n"
+                "  --out FILE          bundle to write (default assets.pak)\n"
+                "  --embed FILE        also write the bundle as a C++ source defining\n"
+                "                      TERRA_ASSET_BUNDLE and TERRA_ASSET_BUNDLE_SIZE\n"
+                "every FILE is packed under the path it is given by, e.g. assets/sounds/Key.mp3\n",
+                program);
+}
+
+bool writeEmbedded(const char* bundlePath, const char* sourcePath) {
+    MappedFile bundle;
+    if (!bundle.open(bundlePath, MapAccess::SEQUENTIAL)) return false;
+    FILE* out = std::fopen(sourcePath, "wb");
+    if (!out) return false;
+    std::fprintf(out, "// Generated by terra_pack from %s; do not edit.\n"
+                      "#include <cstddef>\n\n"
+                      "extern const unsigned char TERRA_ASSET_BUNDLE[];\n"
+                      "extern const size_t TERRA_ASSET_BUNDLE_SIZE;\n\n"
+                      "alignas(16) const unsigned char TERRA_ASSET_BUNDLE[] = {",
+                 bundlePath);
+    for (size_t i = 0; i < bundle.size(); i++) {
+        std::fprintf(out, i % 24 == 0 ? "\n    %u," : "%u,", static_cast<unsigned>(bundle.data()[i]));
+    }
+    std::fprintf(out, "\n};\nconst size_t TERRA_ASSET_BUNDLE_SIZE = %zu;\n", bundle.size());
+    return std::fclose(out) == 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    const char* outPath = "assets.pak";
+    const char* embedPath = nullptr;
+    std::vector<AssetSource> sources;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(arg, "--out") == 0 || std::strcmp(arg, "--embed") == 0) {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", arg);
+                return 1;
+            }
+            (std::strcmp(arg, "--out") == 0 ? outPath : embedPath) = argv[++i];
+        } else if (arg[0] == '-') {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            sources.push_back(AssetSource{arg, arg});
+        }
+    }
+
+    std::string error;
+    if (!writeAssetBundle(outPath, sources, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (embedPath && !writeEmbedded(outPath, embedPath)) {
+        std::fprintf(stderr, "cannot write %s\n", embedPath);
+        return 1;
+    }
+    std::printf("packed %zu assets into %s\n", sources.size(), outPath);
+    return 0;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// Scoped timing zones for the client's frame loop.
+//
+//   PROFILE_ZONE("renderGame");   // times the rest of the enclosing scope
+//   PROFILE_FRAME(seconds);       // closes the frame, once per loop
+//
+// Without TERRA_PROFILE both macros compile to nothing. With it, zones feed
+// the in-process Profiler below, which the overlay reads. With TERRA_TRACY as
+// well they also become Tracy zones and frame marks.
+
+#if defined(TERRA_PROFILE)
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(TERRA_TRACY)
+#include <tracy/Tracy.hpp>
+#define TERRA_TRACY_ZONE(name) ZoneScopedN(name)
+#define TERRA_TRACY_FRAME() FrameMark
+#else
+#define TERRA_TRACY_ZONE(name)
+#define TERRA_TRACY_FRAME()
+#endif
+
+// Per-zone totals for the frame in progress plus a rolling history of whole
+// frames. Single-threaded: zones are only opened on the main thread.
+class Profiler {
+public:
+    static const int MAX_ZONES = 16;
+    static const int HISTORY = 240;  // frames, four seconds at 60 fps
+
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    int zone(const char* name) {
+        for (int i = 0; i < zoneCount; i++) {
+            if (std::strcmp(zoneNames[i], name) == 0) return i;
+        }
+        if (zoneCount == MAX_ZONES) return MAX_ZONES - 1;
+        zoneNames[zoneCount] = name;
+        return zoneCount++;
+    }
+
+    void add(int zone, double seconds) { current[zone] += seconds; }
+
+    void endFrame(double frameSeconds) {
+        frames[next] = frameSeconds;
+        for (int i = 0; i < zoneCount; i++) {
+            zoneHistory[i][next] = current[i];
+            current[i] = 0.0;
+        }
+        next = (next + 1) % HISTORY;
+        recorded = std::min(recorded + 1, HISTORY);
+    }
+
+    int zones() const { return zoneCount; }
+    const char* zoneName(int zone) const { return zoneNames[zone]; }
+    int frameCount() const { return recorded; }
+
+    // i = 0 is the oldest recorded frame.
+    double frame(int i) const { return frames[(next - recorded + i + HISTORY) % HISTORY]; }
+
+    double zoneAverage(int zone) const {
+        double total = 0.0;
+        for (int i = 0; i < recorded; i++) total += zoneHistory[zone][i];
+        return recorded > 0 ? total / recorded : 0.0;
+    }
+
+    // Frame time at quantile q in [0, 1] over the recorded history.
+    double frameQuantile(double q) const {
+        if (recorded == 0) return 0.0;
+        double sorted[HISTORY];
+        for (int i = 0; i < recorded; i++) sorted[i] = frame(i);
+        int rank = std::min(recorded - 1, static_cast<int>(q * recorded));
+        std::nth_element(sorted, sorted + rank, sorted + recorded);
+        return sorted[rank];
+    }
+
+private:
+    const char* zoneNames[MAX_ZONES] = {};
+    int zoneCount = 0;
+    double current[MAX_ZONES] = {};
+    double zoneHistory[MAX_ZONES][HISTORY] = {};
+    double frames[HISTORY] = {};
+    int next = 0;
+    int recorded = 0;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(int zone) : zone(zone), start(std::chrono::steady_clock::now()) {}
+    ~ProfileScope() {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        Profiler::instance().add(zone, elapsed.count());
+    }
+
+private:
+    int zone;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define TERRA_PROFILE_CONCAT2(a, b) a##b
+#define TERRA_PROFILE_CONCAT(a, b) TERRA_PROFILE_CONCAT2(a, b)
+
+#define PROFILE_ZONE(name)                                                                    \
+    TERRA_TRACY_ZONE(name);                                                                   \
+    static const int TERRA_PROFILE_CONCAT(profileZone, __LINE__) = Profiler::instance().zone(name); \
+    ProfileScope TERRA_PROFILE_CONCAT(profileScope, __LINE__)(TERRA_PROFILE_CONCAT(profileZone, __LINE__))
+
+#define PROFILE_FRAME(seconds)                                                                \
+    do {                                                                                      \
+        Profiler::instance().endFrame(seconds);                                               \
+        TERRA_TRACY_FRAME();                                                                  \
+    } while (0)
+
+#else
+
+#define PROFILE_ZONE(name) do {} while (0)
+#define PROFILE_FRAME(seconds) do {} while (0)
+
+#endif
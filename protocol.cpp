@@ -0,0 +1,139 @@
+#include "protocol.h"
+
+#include "varint.h"
+
+namespace {
+
+const int MAX_WIRE_GRID_SIZE = 4096;
+
+}
+
+void MessageWriter::begin(MessageType type) {
+    start = out.size();
+    out.push_back(static_cast<uint8_t>(type));
+}
+
+void MessageWriter::put(uint64_t value) {
+    putVarint(out, value);
+}
+
+void MessageWriter::putMove(const Move& move) {
+    put(static_cast<uint64_t>(move.type));
+    put(move.count);
+    for (int i = 0; i < move.count; i++) {
+        put(static_cast<uint64_t>(move.cells[i]));
+    }
+}
+
+void MessageWriter::putRules(const Rules& rules) {
+    put(static_cast<uint64_t>(rules.gridSize));
+    put(static_cast<uint64_t>(rules.impulseCost));
+    put(static_cast<uint64_t>(rules.winPercentage));
+}
+
+void MessageWriter::putState(const GameState& state) {
+    put(static_cast<uint64_t>(state.turn));
+    put(static_cast<uint64_t>(state.toMove));
+    put(static_cast<uint64_t>(state.playerCharges));
+    put(static_cast<uint64_t>(state.aiCharges));
+    put(static_cast<uint64_t>(state.outcome));
+
+    const CellState* cells = state.board.data();
+    int count = state.board.cellCount();
+    for (int start = 0; start < count;) {
+        int run = start + 1;
+        while (run < count && cells[run] == cells[start]) run++;
+        put(static_cast<uint64_t>(cells[start]));
+        put(static_cast<uint64_t>(run - start));
+        start = run;
+    }
+}
+
+void MessageWriter::end() {
+    uint8_t length[10];
+    uint64_t value = out.size() - start;
+    int bytes = 0;
+    for (; value >= 0x80; value >>= 7) length[bytes++] = static_cast<uint8_t>(value | 0x80);
+    length[bytes++] = static_cast<uint8_t>(value);
+    out.insert(out.begin() + static_cast<std::ptrdiff_t>(start), length, length + bytes);
+}
+
+MessageReader::MessageReader(const uint8_t* payload, size_t size) : cursor(payload), end(payload + size) {
+    if (size > 0) {
+        messageType = static_cast<MessageType>(*cursor++);
+        valid = true;
+    }
+}
+
+bool MessageReader::get(uint64_t& value) {
+    valid = valid && getVarint(cursor, end, value);
+    return valid;
+}
+
+bool MessageReader::getInt(int& value) {
+    uint64_t wide = 0;
+    valid = get(wide) && wide <= static_cast<uint64_t>(INT32_MAX);
+    value = static_cast<int>(wide);
+    return valid;
+}
+
+bool MessageReader::getMove(Move& move) {
+    int type = 0;
+    int count = 0;
+    if (!getInt(type) || !getInt(count) || type > static_cast<int>(MoveType::PASS) || count > 3) {
+        return valid = false;
+    }
+    move = Move();
+    move.type = static_cast<MoveType>(type);
+    move.count = static_cast<uint8_t>(count);
+    for (int i = 0; i < count; i++) {
+        if (!getInt(move.cells[i])) return false;
+    }
+    return true;
+}
+
+bool MessageReader::getRules(Rules& rules) {
+    if (!getInt(rules.gridSize) || !getInt(rules.impulseCost) || !getInt(rules.winPercentage)) return false;
+    valid = rules.gridSize >= 2 && rules.gridSize <= MAX_WIRE_GRID_SIZE && rules.winPercentage <= 100;
+    return valid;
+}
+
+bool MessageReader::getState(GameState& state) {
+    int toMove = 0;
+    int outcome = 0;
+    if (!getInt(state.turn) || !getInt(toMove) || !getInt(state.playerCharges) || !getInt(state.aiCharges) ||
+        !getInt(outcome) || toMove < 1 || toMove > 2 || outcome > static_cast<int>(GameResult::DRAW)) {
+        return valid = false;
+    }
+    state.toMove = static_cast<CellState>(toMove);
+    state.outcome = static_cast<GameResult>(outcome);
+
+    state.board.reset(state.rules.gridSize);
+    int count = state.board.cellCount();
+    for (int start = 0; start < count;) {
+        int owner = 0;
+        int length = 0;
+        if (!getInt(owner) || !getInt(length) || owner > 2 || length < 1 || length > count - start) {
+            return valid = false;
+        }
+        for (int end = start + length; start < end; start++) {
+            state.board.set(start, static_cast<CellState>(owner));
+        }
+    }
+    return true;
+}
+
+long long nextFrame(const uint8_t* data, size_t size, const uint8_t*& payload, size_t& payloadSize) {
+    const uint8_t* cursor = data;
+    uint64_t length = 0;
+    if (!getVarint(cursor, data + size, length)) {
+        return size >= 10 ? -1 : 0;
+    }
+    if (length > MAX_FRAME_BYTES) return -1;
+
+    size_t header = static_cast<size_t>(cursor - data);
+    if (size - header < length) return 0;
+    payload = cursor;
+    payloadSize = static_cast<size_t>(length);
+    return static_cast<long long>(header + length);
+}
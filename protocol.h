@@ -0,0 +1,81 @@
+#pragma once
+
+#include "rules.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Wire format between terra_server and its clients. Each message is a frame:
+// the varint length of the payload, then the payload, a MessageType byte
+// followed by varint fields in the order listed below.
+//
+// Positions never travel whole after a match starts. Both ends run the same
+// rules engine, so MOVE_PLAYED carries only the move and every client applies
+// it to its own copy; STATE, sent once to a client joining a match already in
+// progress, run-length encodes the cells.
+
+const uint16_t DEFAULT_SERVER_PORT = 7420;
+const int DEFAULT_SERVER_MAX_GRID_SIZE = 256;  // largest board a server hosts unless configured otherwise
+const size_t MAX_FRAME_BYTES = 1 << 16;
+
+enum class MessageType : uint8_t {
+    // client -> server
+    CREATE_MATCH = 1,   // gridSize impulseCost winPercentage aiThinkMs (0 = wait for a second client)
+    JOIN_MATCH = 2,     // match: take the AI seat of a match created with aiThinkMs 0
+    PLAY_MOVE = 3,      // match turn move
+    LEAVE_MATCH = 4,    // match
+    // server -> client
+    MATCH_STARTED = 16, // match side gridSize impulseCost winPercentage
+    STATE = 17,         // match turn toMove playerCharges aiCharges outcome runs (owner, length)...
+    MOVE_PLAYED = 18,   // match turn side move outcome; turn is the turn the move was played on
+    REJECTED = 19,      // match reason
+};
+
+enum class RejectReason : uint8_t { NO_SUCH_MATCH, NOT_YOUR_TURN, ILLEGAL_MOVE, MATCH_FULL, SERVER_FULL, BAD_MESSAGE };
+
+// Appends frames to a byte buffer, typically a connection's output queue. The
+// payload is written in place and its length slotted in front by end().
+class MessageWriter {
+public:
+    explicit MessageWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void begin(MessageType type);
+    void put(uint64_t value);
+    void putMove(const Move& move);   // type count cells...
+    void putRules(const Rules& rules);
+    void putState(const GameState& state);  // the STATE fields after match
+    // Writes the frame's length in front of the payload.
+    void end();
+
+private:
+    std::vector<uint8_t>& out;
+    size_t start = 0;
+};
+
+// Reads the fields of one frame's payload. Every get returns false once the
+// payload runs out or holds a value out of range, and stays false.
+class MessageReader {
+public:
+    MessageReader(const uint8_t* payload, size_t size);
+
+    MessageType type() const { return messageType; }
+    bool ok() const { return valid; }
+
+    bool get(uint64_t& value);
+    bool getInt(int& value);
+    bool getMove(Move& move);
+    bool getRules(Rules& rules);
+    // Fills state from STATE fields; its rules must already be set.
+    bool getState(GameState& state);
+
+private:
+    const uint8_t* cursor;
+    const uint8_t* end;
+    MessageType messageType = MessageType::REJECTED;
+    bool valid = false;
+};
+
+// Finds the first complete frame in data[0, size). Returns its total length
+// and sets payload and payloadSize, 0 if more bytes are needed, or -1 if the
+// frame is longer than MAX_FRAME_BYTES.
+long long nextFrame(const uint8_t* data, size_t size, const uint8_t*& payload, size_t& payloadSize);
@@ -0,0 +1,65 @@
+#include "random_ai.h"
+
+#include <algorithm>
+
+bool coinFlip(std::mt19937& rng) {
+    std::uniform_real_distribution<> dis(0.0, 1.0);
+    return dis(rng) < 0.5;
+}
+
+int sampleRanks(int population, int wanted, int* out, std::mt19937& rng) {
+    int available = std::min(wanted, population);
+    int sorted[3];
+    for (int picked = 0; picked < available; picked++) {
+        int rank = std::uniform_int_distribution<>(0, population - 1 - picked)(rng);
+        int slot = 0;
+        while (slot < picked && sorted[slot] <= rank) {
+            rank++;
+            slot++;
+        }
+        for (int i = picked; i > slot; i--) sorted[i] = sorted[i - 1];
+        sorted[slot] = rank;
+        out[picked] = rank;
+    }
+    return available;
+}
+
+int sampleCells(const CellSet& cells, int wanted, int* out, std::mt19937& rng) {
+    if (cells.empty()) {
+        return 0;
+    }
+
+    int available = std::min(wanted, cells.size());
+    std::uniform_int_distribution<> dis(0, cells.size() - 1);
+
+    int picked = 0;
+    while (picked < available) {
+        int cell = cells[dis(rng)];
+        if (std::find(out, out + picked, cell) == out + picked) {
+            out[picked++] = cell;
+        }
+    }
+    return picked;
+}
+
+Move chooseRandomMove(const GameState& state, std::mt19937& rng) {
+    CellState side = state.toMove;
+    Move move;
+
+    if (canUseImpulse(state, side) && coinFlip(rng)) {
+        move.type = MoveType::ATTACK;
+        move.count = static_cast<uint8_t>(sampleCells(state.board.contested(side), 2, move.cells, rng));
+    } else if (canUseImpulse(state, side) && coinFlip(rng)) {
+        move.type = MoveType::SPEED;
+        move.count = static_cast<uint8_t>(sampleCells(state.board.frontier(side), 3, move.cells, rng));
+    } else {
+        move.type = MoveType::CAPTURE;
+        move.count = static_cast<uint8_t>(sampleCells(state.board.frontier(side), 1, move.cells, rng));
+    }
+
+    // an impulse with no targets still costs the turn, as it always has
+    if (move.count == 0) {
+        return Move::pass();
+    }
+    return move;
+}
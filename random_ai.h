@@ -0,0 +1,27 @@
+#pragma once
+
+#include "agent.h"
+#include "rules.h"
+#include <random>
+
+bool coinFlip(std::mt19937& rng);
+
+// Draws min(wanted, population) distinct ranks in [0, population) uniformly,
+// at most 3, without rejection; out receives them in the order drawn.
+int sampleRanks(int population, int wanted, int* out, std::mt19937& rng);
+
+// Picks up to `wanted` distinct cells uniformly from `cells` into `out` and
+// returns how many were picked.
+int sampleCells(const CellSet& cells, int wanted, int* out, std::mt19937& rng);
+
+// The original opponent: with enough charge it flips a coin for an attack,
+// then again for a speed impulse, and otherwise captures a random frontier
+// cell. Works for either side, so it doubles as a self-play policy.
+Move chooseRandomMove(const GameState& state, std::mt19937& rng);
+
+class RandomAgent : public Agent {
+public:
+    Move chooseMove(const GameState& state, std::mt19937& rng) override {
+        return chooseRandomMove(state, rng);
+    }
+};
@@ -0,0 +1,159 @@
+#include "replay.h"
+
+#include "varint.h"
+#include <algorithm>
+
+namespace {
+
+const uint8_t MAGIC[4] = {'T', 'R', 'P', 'L'};
+
+const uint64_t TOKEN_END = 1;
+const uint64_t TOKEN_UNDO = 3;
+
+// The odd tokens after END and UNDO, for every non-capture move shape.
+uint64_t moveToken(const Move& move) {
+    return ((((static_cast<uint64_t>(move.type) << 2) | move.count) + 2) << 1) | 1;
+}
+
+}
+
+void ReplayEncoder::put(uint64_t value) {
+    putVarint(buffer, value);
+}
+
+void ReplayEncoder::beginGame(const Rules& rules, uint32_t seed, uint64_t gameIndex) {
+    if (open) endGame(GameResult::NONE);
+    put(seed);
+    put(gameIndex);
+    put(static_cast<uint64_t>(rules.gridSize));
+    put(static_cast<uint64_t>(rules.impulseCost));
+    put(static_cast<uint64_t>(rules.winPercentage));
+    open = true;
+}
+
+void ReplayEncoder::move(const Move& move) {
+    if (move.type == MoveType::CAPTURE && move.count == 1) {
+        put(static_cast<uint64_t>(move.cells[0]) << 1);
+        return;
+    }
+    put(moveToken(move));
+    for (int i = 0; i < move.count; i++) {
+        put(static_cast<uint64_t>(move.cells[i]));
+    }
+}
+
+void ReplayEncoder::undo() {
+    put(TOKEN_UNDO);
+}
+
+void ReplayEncoder::endGame(GameResult outcome) {
+    put(TOKEN_END);
+    put(static_cast<uint64_t>(outcome));
+    open = false;
+}
+
+bool ReplayFile::open(const char* path) {
+    close();
+    file = std::fopen(path, "a+b");
+    if (!file) return false;
+
+    std::fseek(file, 0, SEEK_END);
+    if (std::ftell(file) == 0) {
+        uint8_t header[5] = {MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3], static_cast<uint8_t>(REPLAY_VERSION)};
+        if (std::fwrite(header, 1, sizeof(header), file) == sizeof(header) && std::fflush(file) == 0) return true;
+    } else {
+        uint8_t header[5] = {};
+        std::fseek(file, 0, SEEK_SET);
+        bool matches = std::fread(header, 1, sizeof(header), file) == sizeof(header) &&
+                       ReplayReader(header, sizeof(header)).valid();
+        // "a" mode appends whatever the position, but reads moved it
+        std::fseek(file, 0, SEEK_END);
+        if (matches) return true;
+    }
+    close();
+    return false;
+}
+
+void ReplayFile::close() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+bool ReplayFile::append(ReplayEncoder& encoder) {
+    const std::vector<uint8_t>& bytes = encoder.bytes();
+    bool written = file && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && std::fflush(file) == 0;
+    encoder.clear();
+    return written;
+}
+
+ReplayReader::ReplayReader(const uint8_t* data, size_t size) : cursor(data), end(data + size) {
+    uint64_t version = 0;
+    if (size >= sizeof(MAGIC) && std::equal(MAGIC, MAGIC + sizeof(MAGIC), data)) {
+        cursor += sizeof(MAGIC);
+        headerOk = get(version) && version == REPLAY_VERSION;
+    }
+}
+
+bool ReplayReader::get(uint64_t& value) {
+    return getVarint(cursor, end, value);
+}
+
+bool ReplayReader::next(ReplayGame& game) {
+    if (!headerOk || cutShort || cursor == end) return false;
+
+    uint64_t seed, gameIndex, gridSize, impulseCost, winPercentage;
+    if (!get(seed) || !get(gameIndex) || !get(gridSize) || !get(impulseCost) || !get(winPercentage)) {
+        cutShort = true;
+        return false;
+    }
+    game.seed = static_cast<uint32_t>(seed);
+    game.gameIndex = gameIndex;
+    game.rules.gridSize = static_cast<int>(gridSize);
+    game.rules.impulseCost = static_cast<int>(impulseCost);
+    game.rules.winPercentage = static_cast<int>(winPercentage);
+    game.moves.clear();
+
+    uint64_t token;
+    while (get(token)) {
+        if ((token & 1) == 0) {
+            game.moves.push_back(Move::capture(static_cast<int>(token >> 1)));
+            continue;
+        }
+        if (token == TOKEN_END) {
+            uint64_t outcome;
+            if (!get(outcome)) break;
+            game.outcome = static_cast<GameResult>(outcome);
+            return true;
+        }
+        if (token == TOKEN_UNDO) {
+            if (!game.moves.empty()) game.moves.pop_back();
+            continue;
+        }
+
+        uint64_t shape = (token >> 1) - 2;
+        Move move;
+        move.type = static_cast<MoveType>(shape >> 2);
+        move.count = static_cast<uint8_t>(shape & 3);
+        for (int i = 0; i < move.count; i++) {
+            uint64_t cell;
+            if (!get(cell)) {
+                cutShort = true;
+                return false;
+            }
+            move.cells[i] = static_cast<int>(cell);
+        }
+        game.moves.push_back(move);
+    }
+    cutShort = true;
+    return false;
+}
+
+bool replayGame(const ReplayGame& game, GameState& state) {
+    state.reset(game.rules);
+    for (const Move& move : game.moves) {
+        if (!applyMove(state, move)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "rules.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Match logs: a file header followed by game records, appended one after the
+// other and never rewritten. Every field is an unsigned LEB128 varint.
+//
+//   file   "TRPL" version
+//   game   seed gameIndex gridSize impulseCost winPercentage token... END outcome
+//   token  cell << 1                      capture of cell
+//          1                              END, followed by the GameResult
+//          3                              UNDO, takes back the previous move
+//          (type << 2 | count) + 2 << 1 | 1, then count cells
+//                                         attack, speed or pass
+//
+// A capture below 64 cells is one byte and never more than three on a 1024
+// board. seed and gameIndex are the arguments seedGame() was given, so agents
+// that only draw from the game's RNG replay the game move for move.
+
+const uint32_t REPLAY_VERSION = 1;
+
+// Builds game records in memory. Callers move bytes() to a ReplayFile as often
+// as they like, after every move to stream, or once per game, and clear() it.
+class ReplayEncoder {
+public:
+    void beginGame(const Rules& rules, uint32_t seed, uint64_t gameIndex);
+    void move(const Move& move);
+    void undo();
+    void endGame(GameResult outcome);
+
+    bool inGame() const { return open; }
+    const std::vector<uint8_t>& bytes() const { return buffer; }
+    void clear() { buffer.clear(); }
+
+private:
+    void put(uint64_t value);
+
+    std::vector<uint8_t> buffer;
+    bool open = false;
+};
+
+// Append-only log on disk. A new file gets the header; an existing one must
+// already be a log of this version.
+class ReplayFile {
+public:
+    ReplayFile() = default;
+    ReplayFile(const ReplayFile&) = delete;
+    ReplayFile& operator=(const ReplayFile&) = delete;
+    ~ReplayFile() { close(); }
+
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Writes and flushes encoder's bytes, then clears them.
+    bool append(ReplayEncoder& encoder);
+
+private:
+    std::FILE* file = nullptr;
+};
+
+// One decoded game. moves already has takebacks applied.
+struct ReplayGame {
+    uint32_t seed = 0;
+    uint64_t gameIndex = 0;
+    Rules rules;
+    std::vector<Move> moves;
+    GameResult outcome = GameResult::NONE;
+};
+
+// Walks the game records of a log held in memory. A record cut short by a
+// writer that stopped mid-game ends the walk and sets truncated().
+class ReplayReader {
+public:
+    ReplayReader(const uint8_t* data, size_t size);
+
+    // False if the data does not start with a log header of this version.
+    bool valid() const { return headerOk; }
+    bool truncated() const { return cutShort; }
+
+    // Decodes the next game into game, reusing its storage.
+    bool next(ReplayGame& game);
+
+private:
+    bool get(uint64_t& value);
+
+    const uint8_t* cursor;
+    const uint8_t* end;
+    bool headerOk = false;
+    bool cutShort = false;
+};
+
+// A log file mapped read-only, so bulk replays decode straight from the page
+// cache without copying.
+class ReplayMap {
+public:
+    bool open(const char* path) { return file.open(path, MapAccess::SEQUENTIAL); }
+    void close() { file.close(); }
+
+    const uint8_t* data() const { return file.data(); }
+    size_t size() const { return file.size(); }
+    ReplayReader reader() const { return ReplayReader(file.data(), file.size()); }
+
+private:
+    MappedFile file;
+};
+
+// Plays game's moves from the starting position into state; false at the
+// first move the rules reject.
+bool replayGame(const ReplayGame& game, GameState& state);
@@ -0,0 +1,252 @@
+#include "rules.h"
+
+namespace {
+
+int& chargesOf(GameState& state, CellState side) {
+    return side == CellState::PLAYER ? state.playerCharges : state.aiCharges;
+}
+
+bool hasDuplicates(const int* cells, int count) {
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            if (cells[i] == cells[j]) return true;
+        }
+    }
+    return false;
+}
+
+bool inRange(const GameState& state, int cell) {
+    return cell >= 0 && cell < state.board.cellCount();
+}
+
+bool isLegalImpulse(const GameState& state, const int* cells, int count, int maxCount,
+                    bool (*isTarget)(const GameState&, CellState, int)) {
+    CellState side = state.toMove;
+    if (state.isOver() || !canUseImpulse(state, side) || count < 1 || count > maxCount) return false;
+    if (hasDuplicates(cells, count)) return false;
+    for (int i = 0; i < count; i++) {
+        if (!isTarget(state, side, cells[i])) return false;
+    }
+    return true;
+}
+
+void endTurn(GameState& state) {
+    CellState mover = state.toMove;
+    state.toMove = opponentOf(mover);
+    state.turn++;
+    if (mover == CellState::AI) {
+        state.outcome = result(state);
+    }
+}
+
+}
+
+void GameState::reset(const Rules& newRules) {
+    rules = newRules;
+    board.reset(rules.gridSize);
+    board.set(0, 0, CellState::PLAYER);
+    board.set(rules.gridSize - 1, rules.gridSize - 1, CellState::AI);
+    playerCharges = 0;
+    aiCharges = 0;
+    toMove = CellState::PLAYER;
+    outcome = GameResult::NONE;
+    turn = 0;
+}
+
+uint64_t GameState::hash() const {
+    uint64_t key = board.hash() ^ zobristCharges(0, playerCharges) ^ zobristCharges(1, aiCharges);
+    return toMove == CellState::AI ? key ^ zobristAiToMove() : key;
+}
+
+bool canUseImpulse(const GameState& state, CellState side) {
+    return state.charges(side) >= state.rules.impulseCost;
+}
+
+bool isLegalCapture(const GameState& state, CellState side, int cell) {
+    return inRange(state, cell) && state.board.frontier(side).contains(cell);
+}
+
+bool isLegalAttackTarget(const GameState& state, CellState side, int cell) {
+    return inRange(state, cell) && state.board.contested(side).contains(cell);
+}
+
+bool hasLegalMove(const GameState& state, CellState side) {
+    return !state.board.frontier(side).empty() || (canUseImpulse(state, side) && !state.board.contested(side).empty());
+}
+
+bool applyCapture(GameState& state, int cell) {
+    CellState side = state.toMove;
+    if (state.isOver() || !isLegalCapture(state, side, cell)) return false;
+
+    state.board.set(cell, side);
+    chargesOf(state, side)++;
+    endTurn(state);
+    return true;
+}
+
+bool applyAttack(GameState& state, const int* cells, int count) {
+    CellState side = state.toMove;
+    if (!isLegalImpulse(state, cells, count, 2, isLegalAttackTarget)) return false;
+
+    for (int i = 0; i < count; i++) {
+        state.board.set(cells[i], side);
+    }
+    chargesOf(state, side) -= state.rules.impulseCost;
+    endTurn(state);
+    return true;
+}
+
+bool applySpeed(GameState& state, const int* cells, int count) {
+    CellState side = state.toMove;
+    if (!isLegalImpulse(state, cells, count, 3, isLegalCapture)) return false;
+
+    for (int i = 0; i < count; i++) {
+        state.board.set(cells[i], side);
+    }
+    chargesOf(state, side) -= state.rules.impulseCost;
+    endTurn(state);
+    return true;
+}
+
+void applyPass(GameState& state) {
+    if (state.isOver()) return;
+    endTurn(state);
+}
+
+bool isLegalMove(const GameState& state, const Move& move) {
+    switch (move.type) {
+        case MoveType::CAPTURE:
+            return !state.isOver() && move.count == 1 && isLegalCapture(state, state.toMove, move.cells[0]);
+        case MoveType::ATTACK: return isLegalImpulse(state, move.cells, move.count, 2, isLegalAttackTarget);
+        case MoveType::SPEED: return isLegalImpulse(state, move.cells, move.count, 3, isLegalCapture);
+        case MoveType::PASS: return true;
+    }
+    return false;
+}
+
+bool applyMove(GameState& state, const Move& move) {
+    switch (move.type) {
+        case MoveType::CAPTURE: return move.count == 1 && applyCapture(state, move.cells[0]);
+        case MoveType::ATTACK: return applyAttack(state, move.cells, move.count);
+        case MoveType::SPEED: return applySpeed(state, move.cells, move.count);
+        case MoveType::PASS: applyPass(state); return true;
+    }
+    return false;
+}
+
+bool makeMove(GameState& state, const Move& move, MoveJournal& journal) {
+    UndoRecord& record = journal.push();
+    record.move = move;
+    for (int i = 0; i < move.count && i < 3; i++) {
+        record.previous[i] = inRange(state, move.cells[i]) ? state.board.at(move.cells[i]) : CellState::NEUTRAL;
+    }
+    record.playerCharges = state.playerCharges;
+    record.aiCharges = state.aiCharges;
+    record.toMove = state.toMove;
+    record.outcome = state.outcome;
+    record.turn = state.turn;
+
+    if (state.isOver() || !applyMove(state, move)) {
+        journal.pop();
+        return false;
+    }
+    return true;
+}
+
+bool undoMove(GameState& state, MoveJournal& journal) {
+    if (journal.empty()) return false;
+
+    const UndoRecord& record = journal.pop();
+    for (int i = record.move.count - 1; i >= 0; i--) {
+        state.board.set(record.move.cells[i], record.previous[i]);
+    }
+    state.playerCharges = record.playerCharges;
+    state.aiCharges = record.aiCharges;
+    state.toMove = record.toMove;
+    state.outcome = record.outcome;
+    state.turn = record.turn;
+    return true;
+}
+
+void legalMoves(const GameState& state, MoveList& moves) {
+    if (state.isOver()) return;
+
+    size_t first = moves.size();
+    CellState side = state.toMove;
+    const CellSet& frontier = state.board.frontier(side);
+    for (int cell : frontier) {
+        moves.push_back(Move::capture(cell));
+    }
+
+    if (canUseImpulse(state, side)) {
+        const CellSet& targets = state.board.contested(side);
+        Move attack;
+        attack.type = MoveType::ATTACK;
+        if (targets.size() == 1) {
+            attack.count = 1;
+            attack.cells[0] = targets[0];
+            moves.push_back(attack);
+        }
+        attack.count = 2;
+        for (int i = 0; i < targets.size(); i++) {
+            for (int j = i + 1; j < targets.size(); j++) {
+                attack.cells[0] = targets[i];
+                attack.cells[1] = targets[j];
+                moves.push_back(attack);
+            }
+        }
+
+        Move speed;
+        speed.type = MoveType::SPEED;
+        if (frontier.size() < 3) {
+            speed.count = static_cast<uint8_t>(frontier.size());
+            for (int i = 0; i < frontier.size(); i++) speed.cells[i] = frontier[i];
+            if (speed.count > 0) moves.push_back(speed);
+        }
+        speed.count = 3;
+        for (int i = 0; i < frontier.size(); i++) {
+            for (int j = i + 1; j < frontier.size(); j++) {
+                for (int k = j + 1; k < frontier.size(); k++) {
+                    speed.cells[0] = frontier[i];
+                    speed.cells[1] = frontier[j];
+                    speed.cells[2] = frontier[k];
+                    moves.push_back(speed);
+                }
+            }
+        }
+    }
+
+    if (moves.size() == first) {
+        moves.push_back(Move::pass());
+    }
+}
+
+uint64_t hashAfterMove(uint64_t hash, CellState side, int charges, int impulseCost, const Move& move) {
+    int s = side == CellState::PLAYER ? 0 : 1;
+    uint64_t key = hash ^ zobristAiToMove();
+    for (int i = 0; i < move.count; i++) {
+        key ^= zobristCell(move.cells[i], s);
+        if (move.type == MoveType::ATTACK) key ^= zobristCell(move.cells[i], 1 - s);
+    }
+
+    int after = charges;
+    switch (move.type) {
+        case MoveType::CAPTURE: after++; break;
+        case MoveType::ATTACK:
+        case MoveType::SPEED: after -= impulseCost; break;
+        case MoveType::PASS: break;
+    }
+    return key ^ zobristCharges(s, charges) ^ zobristCharges(s, after);
+}
+
+GameResult result(const GameState& state) {
+    int playerCells = state.cells(CellState::PLAYER);
+    int aiCells = state.cells(CellState::AI);
+    GameResult outcome = resultFromCounts(playerCells, aiCells, state.rules.targetCells());
+    if (outcome != GameResult::NONE) return outcome;
+
+    const Board& board = state.board;
+    if (!board.frontier(CellState::PLAYER).empty() || !board.frontier(CellState::AI).empty()) return outcome;
+    return sealedResult(playerCells, aiCells, state.playerCharges, state.aiCharges, state.rules.impulseCost,
+                        !board.contested(CellState::PLAYER).empty(), state.rules.targetCells());
+}
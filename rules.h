@@ -0,0 +1,163 @@
+#pragma once
+
+#include "board.h"
+#include <cstdint>
+#include <vector>
+
+const int DEFAULT_GRID_SIZE = 10;
+const int IMPULSE_COST = 3;
+const int WIN_PERCENTAGE = 45;
+
+enum class GameResult { NONE, PLAYER_WIN, AI_WIN, DRAW };
+enum class MoveType : uint8_t { CAPTURE, ATTACK, SPEED, PASS };
+
+constexpr int targetCellsFor(int gridSize, int winPercentage) {
+    return (gridSize * gridSize * winPercentage + 99) / 100;
+}
+
+// The win check shared by every engine: whoever holds targetCells wins, both
+// at once is a draw.
+constexpr GameResult resultFromCounts(int playerCells, int aiCells, int targetCells) {
+    return playerCells >= targetCells && aiCells >= targetCells ? GameResult::DRAW
+         : playerCells >= targetCells ? GameResult::PLAYER_WIN
+         : aiCells >= targetCells ? GameResult::AI_WIN
+         : GameResult::NONE;
+}
+
+// The check for a sealed position, one in which neither side has a frontier.
+// No move creates neutral cells, so none will be captured again: only attacks
+// can still move cells, at most two each, paid for from charges that can no
+// longer grow. `bordering` is whether any PLAYER cell touches an AI cell; if
+// not, no attack is possible now or later. The larger side wins once no attack
+// is left, or earlier if the attacks left can neither bring a side to the
+// target nor change who is ahead. NONE while they still could.
+constexpr GameResult sealedResult(int playerCells, int aiCells, int playerCharges, int aiCharges,
+                                  int impulseCost, bool bordering, int targetCells) {
+    if (bordering && impulseCost <= 0) return GameResult::NONE;
+    int playerSwing = bordering ? 2 * (playerCharges / impulseCost) : 0;
+    int aiSwing = bordering ? 2 * (aiCharges / impulseCost) : 0;
+    if (playerCells + playerSwing >= targetCells || aiCells + aiSwing >= targetCells) return GameResult::NONE;
+
+    return playerCells - aiSwing > aiCells + aiSwing ? GameResult::PLAYER_WIN
+         : aiCells - playerSwing > playerCells + playerSwing ? GameResult::AI_WIN
+         : playerSwing == 0 && aiSwing == 0 ? GameResult::DRAW
+         : GameResult::NONE;
+}
+
+// Rule constants for one match. Everything the engine needs to know about the
+// variant being played lives here so batch runs can sweep them.
+struct Rules {
+    int gridSize = DEFAULT_GRID_SIZE;
+    int impulseCost = IMPULSE_COST;
+    int winPercentage = WIN_PERCENTAGE;
+
+    constexpr int targetCells() const { return targetCellsFor(gridSize, winPercentage); }
+};
+
+// A capture takes one cell, an attack flips up to two enemy cells and a speed
+// impulse captures up to three cells. Cells are board indices.
+struct Move {
+    MoveType type = MoveType::PASS;
+    uint8_t count = 0;
+    int cells[3] = {-1, -1, -1};
+
+    static Move capture(int cell) {
+        Move move;
+        move.type = MoveType::CAPTURE;
+        move.count = 1;
+        move.cells[0] = cell;
+        return move;
+    }
+
+    static Move pass() { return Move(); }
+};
+
+using MoveList = std::vector<Move>;
+
+// Complete, renderer-independent state of a match.
+struct GameState {
+    Rules rules;
+    Board board;
+    int playerCharges = 0;
+    int aiCharges = 0;
+    CellState toMove = CellState::PLAYER;
+    GameResult outcome = GameResult::NONE;
+    int turn = 0;
+
+    void reset(const Rules& newRules);
+
+    int cells(CellState side) const { return board.count(side); }
+    int charges(CellState side) const { return side == CellState::PLAYER ? playerCharges : aiCharges; }
+    bool isOver() const { return outcome != GameResult::NONE; }
+
+    // Zobrist key of the position: cells, side to move and both charge counts.
+    uint64_t hash() const;
+};
+
+bool canUseImpulse(const GameState& state, CellState side);
+bool isLegalCapture(const GameState& state, CellState side, int cell);
+bool isLegalAttackTarget(const GameState& state, CellState side, int cell);
+// Whether side has any move other than a pass.
+bool hasLegalMove(const GameState& state, CellState side);
+
+// Each apply* acts for state.toMove, returns false and leaves the state untouched
+// if the move is illegal, and otherwise hands the turn to the other side. The
+// result is evaluated after the AI moves, so a player reaching the target still
+// gives the AI its reply and a chance to draw.
+bool applyCapture(GameState& state, int cell);
+bool applyAttack(GameState& state, const int* cells, int count);
+bool applySpeed(GameState& state, const int* cells, int count);
+void applyPass(GameState& state);
+bool applyMove(GameState& state, const Move& move);
+// Whether applyMove would accept move, without playing it.
+bool isLegalMove(const GameState& state, const Move& move);
+
+// Everything a move overwrote, enough for undoMove to put the state back.
+struct UndoRecord {
+    Move move;
+    CellState previous[3];  // prior owners of move.cells
+    int playerCharges;
+    int aiCharges;
+    CellState toMove;
+    GameResult outcome;
+    int turn;
+};
+
+// Stack of applied moves. Records are pushed and popped in place, so once a
+// journal has grown to a game's length it never allocates again.
+class MoveJournal {
+public:
+    void clear() { depth = 0; }
+    bool empty() const { return depth == 0; }
+    int size() const { return static_cast<int>(depth); }
+
+    UndoRecord& push() {
+        if (depth == records.size()) records.emplace_back();
+        return records[depth++];
+    }
+    const UndoRecord& pop() { return records[--depth]; }
+    const UndoRecord& back() const { return records[depth - 1]; }
+
+private:
+    std::vector<UndoRecord> records;
+    size_t depth = 0;
+};
+
+// applyMove that also records the move in journal when it is legal.
+bool makeMove(GameState& state, const Move& move, MoveJournal& journal);
+// Reverts the most recent makeMove; false if the journal is empty.
+bool undoMove(GameState& state, MoveJournal& journal);
+
+// Appends every legal move for state.toMove; a pass is only generated when the
+// side has nothing else to do. Impulses are enumerated as all pairs/triples of
+// targets, which grows quickly with the frontier; callers on big boards should
+// sample impulses instead.
+void legalMoves(const GameState& state, MoveList& moves);
+
+// The win check, then the sealed-position check, so every game ends once
+// neither side can change the outcome.
+GameResult result(const GameState& state);
+
+// Zobrist key after side plays move from a position keyed `hash` in which side
+// holds `charges`, without playing it. Every engine's hashAfter goes through here.
+uint64_t hashAfterMove(uint64_t hash, CellState side, int charges, int impulseCost, const Move& move);
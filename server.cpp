@@ -0,0 +1,457 @@
+#include "server.h"
+
+#include "mcts.h"
+#include "telemetry.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+const size_t READ_CHUNK = 4096;
+const size_t MAX_PENDING_OUTPUT = 1 << 20;  // a client this far behind is dropped
+const int ACCEPTS_PER_PASS = 256;
+
+int sideIndex(CellState side) {
+    return side == CellState::PLAYER ? 0 : 1;
+}
+
+}
+
+GameServer::GameServer(const ServerConfig& config) : config(config) {}
+
+GameServer::~GameServer() {
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        stopping.store(true);
+    }
+    queueReady.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (Connection& connection : connections) {
+        if (connection.socket != INVALID_SOCKET_HANDLE) closeSocket(connection.socket);
+    }
+    for (Socket socket : {listener, wake[0], wake[1]}) {
+        if (socket != INVALID_SOCKET_HANDLE) closeSocket(socket);
+    }
+    netShutdown();
+}
+
+bool GameServer::start() {
+    if (!netStartup()) return false;
+    listener = listenOn(config.port);
+    if (listener == INVALID_SOCKET_HANDLE || !socketPair(wake)) return false;
+
+    matches.resize(std::max(1, config.maxMatches));
+    for (int slot = static_cast<int>(matches.size()) - 1; slot >= 0; slot--) {
+        freeMatches.push_back(slot);
+    }
+
+    int threads = config.searchThreads;
+    if (threads <= 0) threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    for (int id = 0; id < threads; id++) {
+        workers.emplace_back(&GameServer::searchWorker, this, id);
+    }
+    return true;
+}
+
+ServerStats GameServer::stats() const {
+    ServerStats stats;
+    stats.connections = openConnections.load(std::memory_order_relaxed);
+    stats.matches = activeMatches.load(std::memory_order_relaxed);
+    stats.movesPlayed = movesPlayed.load(std::memory_order_relaxed);
+    stats.searches = searches.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void GameServer::run(const std::atomic<bool>& stop) {
+    std::vector<PollEntry> entries;
+    std::vector<int> owners;
+    uint8_t drained[64];
+
+    while (!stop.load()) {
+        entries.clear();
+        owners.clear();
+        entries.push_back(PollEntry{listener, false, false, false, false});
+        entries.push_back(PollEntry{wake[0], false, false, false, false});
+        for (int c = 0; c < static_cast<int>(connections.size()); c++) {
+            const Connection& connection = connections[c];
+            if (connection.socket == INVALID_SOCKET_HANDLE) continue;
+            bool backlog = connection.outputSent < connection.output.size();
+            entries.push_back(PollEntry{connection.socket, backlog, false, false, false});
+            owners.push_back(c);
+        }
+
+        if (pollSockets(entries.data(), entries.size(), 100) <= 0) continue;
+
+        if (entries[1].readable) {
+            while (receiveSome(wake[0], drained, sizeof(drained)) > 0) {
+            }
+            applySearchResults();
+        }
+        for (size_t i = 0; i < owners.size(); i++) {
+            const PollEntry& entry = entries[i + 2];
+            if (entry.readable || entry.failed) readFrom(owners[i]);
+            if (entry.writable) flush(owners[i]);
+        }
+        if (entries[0].readable) acceptConnections();
+
+        for (int c : pendingOutput) {
+            connections[c].flushQueued = false;
+            flush(c);
+        }
+        pendingOutput.clear();
+        for (int c : owners) {
+            if (connections[c].closing) closeConnection(c);
+        }
+    }
+}
+
+void GameServer::acceptConnections() {
+    for (int accepted = 0; accepted < ACCEPTS_PER_PASS; accepted++) {
+        Socket socket = acceptClient(listener);
+        if (socket == INVALID_SOCKET_HANDLE) return;
+
+        int c;
+        if (freeConnections.empty()) {
+            c = static_cast<int>(connections.size());
+            connections.emplace_back();
+        } else {
+            c = freeConnections.back();
+            freeConnections.pop_back();
+        }
+        connections[c].socket = socket;
+        openConnections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void GameServer::readFrom(int c) {
+    Connection& connection = connections[c];
+    uint8_t chunk[READ_CHUNK];
+    while (true) {
+        long long received = receiveSome(connection.socket, chunk, sizeof(chunk));
+        if (received < 0) connection.closing = true;
+        if (received <= 0) break;
+        connection.input.insert(connection.input.end(), chunk, chunk + received);
+    }
+
+    size_t offset = 0;
+    while (!connection.closing) {
+        const uint8_t* payload = nullptr;
+        size_t size = 0;
+        long long frame = nextFrame(connection.input.data() + offset, connection.input.size() - offset, payload, size);
+        if (frame < 0) connection.closing = true;
+        if (frame <= 0) break;
+
+        MessageReader message(payload, size);
+        handleMessage(c, message);
+        offset += static_cast<size_t>(frame);
+    }
+    connection.input.erase(connection.input.begin(), connection.input.begin() + static_cast<std::ptrdiff_t>(offset));
+}
+
+void GameServer::flush(int c) {
+    Connection& connection = connections[c];
+    while (connection.outputSent < connection.output.size()) {
+        long long sent = sendSome(connection.socket, connection.output.data() + connection.outputSent,
+                                  connection.output.size() - connection.outputSent);
+        if (sent < 0) connection.closing = true;
+        if (sent <= 0) break;
+        connection.outputSent += static_cast<size_t>(sent);
+    }
+    if (connection.outputSent == connection.output.size()) {
+        connection.output.clear();
+        connection.outputSent = 0;
+    } else if (connection.output.size() - connection.outputSent > MAX_PENDING_OUTPUT) {
+        connection.closing = true;
+    }
+}
+
+MessageWriter GameServer::writeTo(int c) {
+    Connection& connection = connections[c];
+    if (!connection.flushQueued) {
+        connection.flushQueued = true;
+        pendingOutput.push_back(c);
+    }
+    return MessageWriter(connection.output);
+}
+
+void GameServer::closeConnection(int c) {
+    Connection& connection = connections[c];
+    while (!connection.matches.empty()) {
+        int slot = connection.matches.back();
+        Match& match = matches[slot];
+        for (int seat : match.seats) {
+            if (seat >= 0 && seat != c) reject(seat, matchId(slot), RejectReason::NO_SUCH_MATCH);
+        }
+        releaseMatch(slot);
+    }
+    closeSocket(connection.socket);
+    connection.socket = INVALID_SOCKET_HANDLE;
+    connection.input.clear();
+    connection.output.clear();
+    connection.outputSent = 0;
+    connection.closing = false;
+    freeConnections.push_back(c);
+    openConnections.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void GameServer::reject(int c, uint64_t id, RejectReason reason) {
+    MessageWriter out = writeTo(c);
+    out.begin(MessageType::REJECTED);
+    out.put(id);
+    out.put(static_cast<uint64_t>(reason));
+    out.end();
+}
+
+void GameServer::handleMessage(int c, MessageReader& message) {
+    uint64_t id = 0;
+    int slot = -1;
+    switch (message.type()) {
+        case MessageType::CREATE_MATCH: {
+            Rules rules;
+            int thinkMs = 0;
+            if (!message.getRules(rules) || !message.getInt(thinkMs) || rules.gridSize > config.maxGridSize) break;
+            if (createMatch(c, rules, thinkMs) < 0) reject(c, 0, RejectReason::SERVER_FULL);
+            return;
+        }
+
+        case MessageType::JOIN_MATCH: {
+            if (!message.get(id)) break;
+            Match* match = findMatch(id, slot);
+            if (!match) {
+                reject(c, id, RejectReason::NO_SUCH_MATCH);
+            } else if (match->seats[1] != OPEN_SEAT || match->seats[0] == c) {
+                reject(c, id, RejectReason::MATCH_FULL);
+            } else {
+                match->seats[1] = c;
+                connections[c].matches.push_back(slot);
+                MessageWriter out = writeTo(c);
+                out.begin(MessageType::MATCH_STARTED);
+                out.put(id);
+                out.put(static_cast<uint64_t>(CellState::AI));
+                out.putRules(match->state.rules);
+                out.end();
+                out.begin(MessageType::STATE);
+                out.put(id);
+                out.putState(match->state);
+                out.end();
+            }
+            return;
+        }
+
+        case MessageType::PLAY_MOVE: {
+            int turn = 0;
+            Move move;
+            if (!message.get(id) || !message.getInt(turn) || !message.getMove(move)) break;
+            Match* match = findMatch(id, slot);
+            if (!match) {
+                reject(c, id, RejectReason::NO_SUCH_MATCH);
+            } else if (match->state.isOver() || match->seats[sideIndex(match->state.toMove)] != c ||
+                       turn != match->state.turn) {
+                reject(c, id, RejectReason::NOT_YOUR_TURN);
+            } else {
+                playMove(slot, move);
+            }
+            return;
+        }
+
+        case MessageType::LEAVE_MATCH: {
+            if (!message.get(id)) break;
+            Match* match = findMatch(id, slot);
+            if (!match || (match->seats[0] != c && match->seats[1] != c)) {
+                reject(c, id, RejectReason::NO_SUCH_MATCH);
+                return;
+            }
+            for (int seat : match->seats) {
+                if (seat >= 0 && seat != c) reject(seat, id, RejectReason::NO_SUCH_MATCH);
+            }
+            releaseMatch(slot);
+            return;
+        }
+
+        default:
+            break;
+    }
+    reject(c, id, RejectReason::BAD_MESSAGE);
+}
+
+uint64_t GameServer::matchId(int slot) const {
+    return (static_cast<uint64_t>(matches[slot].generation) << 32) | static_cast<uint32_t>(slot);
+}
+
+GameServer::Match* GameServer::findMatch(uint64_t id, int& slot) {
+    slot = static_cast<int>(id & 0xffffffffu);
+    if (slot >= static_cast<int>(matches.size())) return nullptr;
+    Match& match = matches[slot];
+    return match.active && match.generation == static_cast<uint32_t>(id >> 32) ? &match : nullptr;
+}
+
+int GameServer::createMatch(int c, const Rules& rules, int thinkMs) {
+    if (freeMatches.empty()) return -1;
+    int slot = freeMatches.back();
+    freeMatches.pop_back();
+
+    Match& match = matches[slot];
+    match.generation++;
+    match.active = true;
+    match.searching = false;
+    match.seats[0] = c;
+    match.seats[1] = thinkMs > 0 ? AI_SEAT : OPEN_SEAT;
+    match.thinkMs = std::min(thinkMs, config.maxThinkMs);
+    match.state.reset(rules);
+    connections[c].matches.push_back(slot);
+    activeMatches.fetch_add(1, std::memory_order_relaxed);
+
+    MessageWriter out = writeTo(c);
+    out.begin(MessageType::MATCH_STARTED);
+    out.put(matchId(slot));
+    out.put(static_cast<uint64_t>(CellState::PLAYER));
+    out.putRules(rules);
+    out.end();
+    return slot;
+}
+
+// Plays move for the side to move, tells every human seat, and hands the
+// turn to the AI or ends the match as needed. The AI's moves come from its own
+// legal move list, and searchMcts() checks a tablebase move before playing it,
+// so only a client's move can be rejected here.
+void GameServer::playMove(int slot, const Move& move) {
+    Match& match = matches[slot];
+    int turn = match.state.turn;
+    CellState side = match.state.toMove;
+    int mover = match.seats[sideIndex(side)];
+    if (!applyMove(match.state, move)) {
+        if (mover >= 0) reject(mover, matchId(slot), RejectReason::ILLEGAL_MOVE);
+        return;
+    }
+    movesPlayed.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t id = matchId(slot);
+    TelemetrySample sample;
+    sample.side = static_cast<uint8_t>(side);
+    sample.turn = static_cast<uint32_t>(turn);
+    sample.match = id;
+    if (move.type == MoveType::ATTACK || move.type == MoveType::SPEED) {
+        sample.event = TelemetryEvent::IMPULSE;
+        sample.detail = static_cast<uint16_t>(move.type);
+        sample.count = move.count;
+        recordTelemetry(sample);
+    }
+    if (match.state.isOver()) {
+        sample.event = TelemetryEvent::MATCH_END;
+        sample.detail = static_cast<uint16_t>(match.state.outcome);
+        sample.count = 0;
+        recordTelemetry(sample);
+    }
+    for (int seat : match.seats) {
+        if (seat < 0) continue;
+        MessageWriter out = writeTo(seat);
+        out.begin(MessageType::MOVE_PLAYED);
+        out.put(id);
+        out.put(static_cast<uint64_t>(turn));
+        out.put(static_cast<uint64_t>(side));
+        out.putMove(move);
+        out.put(static_cast<uint64_t>(match.state.outcome));
+        out.end();
+    }
+
+    if (match.state.isOver()) {
+        releaseMatch(slot);
+    } else if (match.seats[sideIndex(match.state.toMove)] == AI_SEAT) {
+        scheduleSearch(slot);
+    }
+}
+
+void GameServer::releaseMatch(int slot) {
+    Match& match = matches[slot];
+    for (int& seat : match.seats) {
+        if (seat >= 0) {
+            std::vector<int>& held = connections[seat].matches;
+            held.erase(std::remove(held.begin(), held.end(), slot), held.end());
+        }
+        seat = OPEN_SEAT;
+    }
+    match.active = false;
+    match.searching = false;
+    freeMatches.push_back(slot);
+    activeMatches.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void GameServer::scheduleSearch(int slot) {
+    Match& match = matches[slot];
+    match.searching = true;
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        jobs.push_back(SearchJob{slot, match.generation, match.thinkMs, match.state});
+    }
+    queueReady.notify_one();
+}
+
+void GameServer::applySearchResults() {
+    std::vector<SearchResult> ready;
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        ready.swap(results);
+    }
+    for (const SearchResult& result : ready) {
+        Match& match = matches[result.slot];
+        // the match may have ended, or its slot been reused, while the search ran
+        if (!match.active || !match.searching || match.generation != result.generation ||
+            match.state.turn != result.turn) {
+            continue;
+        }
+        match.searching = false;
+        playMove(result.slot, result.move);
+    }
+}
+
+void GameServer::searchWorker(int id) {
+    std::mt19937 rng(std::random_device{}() + static_cast<uint32_t>(id));
+    TranspositionTable table;
+    MctsConfig search;
+    search.threads = 1;  // one tree per search thread, see server.h
+    search.cancel = &stopping;
+    search.table = &table;
+    search.tablebase = config.tablebase;
+    int lastSlot = -1;
+    uint32_t lastGeneration = 0;
+
+    while (true) {
+        SearchJob job;
+        {
+            std::unique_lock<std::mutex> lock(queueLock);
+            queueReady.wait(lock, [&] { return stopping.load() || !jobs.empty(); });
+            if (stopping.load()) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        // statistics from another match would only mislead the search
+        if (job.slot != lastSlot || job.generation != lastGeneration) {
+            table.clear();
+            lastSlot = job.slot;
+            lastGeneration = job.generation;
+        }
+        search.timeBudget = job.thinkMs / 1000.0;
+        MctsStats searchStats;
+        Move move = searchMcts(job.position, search, rng, &searchStats);
+        searches.fetch_add(1, std::memory_order_relaxed);
+
+        TelemetrySample sample;
+        sample.event = TelemetryEvent::SEARCH;
+        sample.side = static_cast<uint8_t>(job.position.toMove);
+        sample.turn = static_cast<uint32_t>(job.position.turn);
+        sample.match = (static_cast<uint64_t>(job.generation) << 32) | static_cast<uint32_t>(job.slot);
+        sample.value = static_cast<uint64_t>(searchStats.seconds * 1e9);
+        sample.count = static_cast<uint64_t>(searchStats.nodes);
+        recordTelemetry(sample);
+
+        {
+            std::lock_guard<std::mutex> lock(queueLock);
+            results.push_back(SearchResult{job.slot, job.generation, job.position.turn, move});
+        }
+        uint8_t signal = 1;
+        sendSome(wake[1], &signal, 1);
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "net.h"
+#include "protocol.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Tablebase;
+
+struct ServerConfig {
+    uint16_t port = DEFAULT_SERVER_PORT;
+    int maxMatches = 16384;   // match slots, allocated up front
+    int searchThreads = 0;    // 0 = one per hardware thread, less the event loop's
+    int maxThinkMs = 1000;    // cap on the AI budget a client may ask for
+    int maxGridSize = DEFAULT_SERVER_MAX_GRID_SIZE;  // largest board a client may ask for
+    const Tablebase* tablebase = nullptr;  // solved 7x7 endgames, shared by every search
+};
+
+struct ServerStats {
+    long long connections = 0;
+    long long matches = 0;
+    long long movesPlayed = 0;
+    long long searches = 0;
+};
+
+// Hosts any number of independent matches in one process. A single event
+// loop thread owns every socket and every match and never blocks on the AI:
+// AI turns go to a pool of search threads, each with its own RNG and
+// transposition table, and come back through a wake-up socket.
+//
+// Those search threads are the server's own rather than sharedPool()'s. The
+// shared pool only offers parallelFor(), which blocks its caller until the
+// batch is done, and the event loop must hand a search off and keep serving
+// sockets. Each search thread also keeps its transposition table from one
+// turn of a match to the next, which a pool task could not hold on to. Every
+// server search grows a single tree, so none of them ever enters the shared
+// pool either.
+//
+// Matches live in a fixed pool of slots whose GameState storage is reused
+// from one match to the next. A match id is its slot plus a generation count,
+// so a stale id, or a search result for a match that has since ended, never
+// reaches the slot's next match.
+class GameServer {
+public:
+    explicit GameServer(const ServerConfig& config);
+    ~GameServer();
+
+    // Binds the port and starts the search threads.
+    bool start();
+    // Runs the event loop until stop is set; checks it at least every 100 ms.
+    void run(const std::atomic<bool>& stop);
+
+    // Counters as of the loop's last pass; safe to read from any thread.
+    ServerStats stats() const;
+
+private:
+    static const int AI_SEAT = -1;
+    static const int OPEN_SEAT = -2;
+
+    struct Connection {
+        Socket socket = INVALID_SOCKET_HANDLE;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        size_t outputSent = 0;
+        std::vector<int> matches;  // slots with a seat held by this connection
+        bool flushQueued = false;
+        bool closing = false;
+    };
+
+    struct Match {
+        uint32_t generation = 0;
+        bool active = false;
+        bool searching = false;
+        int seats[2] = {OPEN_SEAT, OPEN_SEAT};  // connection per side, or AI_SEAT
+        int thinkMs = 0;
+        GameState state;
+    };
+
+    struct SearchJob {
+        int slot;
+        uint32_t generation;
+        int thinkMs;
+        GameState position;
+    };
+
+    struct SearchResult {
+        int slot;
+        uint32_t generation;
+        int turn;
+        Move move;
+    };
+
+    void acceptConnections();
+    void readFrom(int connection);
+    void flush(int connection);
+    MessageWriter writeTo(int connection);
+    void closeConnection(int connection);
+    void handleMessage(int connection, MessageReader& message);
+    void reject(int connection, uint64_t matchId, RejectReason reason);
+
+    int createMatch(int connection, const Rules& rules, int thinkMs);
+    Match* findMatch(uint64_t matchId, int& slot);
+    uint64_t matchId(int slot) const;
+    void playMove(int slot, const Move& move);
+    void releaseMatch(int slot);
+    void scheduleSearch(int slot);
+    void applySearchResults();
+
+    void searchWorker(int id);
+
+    ServerConfig config;
+    Socket listener = INVALID_SOCKET_HANDLE;
+    Socket wake[2] = {INVALID_SOCKET_HANDLE, INVALID_SOCKET_HANDLE};  // workers write [1], the loop polls [0]
+
+    std::vector<Connection> connections;
+    std::vector<int> freeConnections;
+    std::vector<int> pendingOutput;  // connections written to during this pass
+    std::vector<Match> matches;
+    std::vector<int> freeMatches;
+    std::vector<uint8_t> scratch;
+
+    std::vector<std::thread> workers;
+    std::mutex queueLock;
+    std::condition_variable queueReady;
+    std::deque<SearchJob> jobs;
+    std::vector<SearchResult> results;
+    std::atomic<bool> stopping{false};
+
+    std::atomic<long long> openConnections{0};
+    std::atomic<long long> activeMatches{0};
+    std::atomic<long long> movesPlayed{0};
+    std::atomic<long long> searches{0};
+};
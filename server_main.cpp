@@ -0,0 +1,217 @@
+#include "net_client.h"
+#include "random_ai.h"
+#include "server.h"
+#include "tablebase.h"
+#include "telemetry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> stopRequested{false};
+
+void requestStop(int) {
+    stopRequested.store(true);
+}
+
+void printUsage(const char* program) {
+    std::printf("usage: %s [options]\n"
+                "  --port N            listen port (default %u)\n"
+                "  --max-matches N     concurrent match slots (default 16384)\n"
+                "  --search-threads N  AI search threads, 0 = cores - 1 (default 0)\n"
+                "  --max-think-ms N    cap on a match's AI budget (default 1000)\n"
+                "  --tablebase FILE    play solved 7x7 endgames from this tablebase\n"
+                "  --telemetry FILE    append search, impulse and match metrics to FILE\n"
+                "load test, against a running server instead of serving:\n"
+                "  --load-test HOST    connect to HOST on --port\n"
+                "  --connections N     client connections (default 16)\n"
+                "  --matches N         matches per connection (default 64)\n"
+                "  --think-ms N        AI budget each match asks for (default 5)\n"
+                "  --size N            board size (default %d)\n",
+                program, static_cast<unsigned>(DEFAULT_SERVER_PORT), DEFAULT_GRID_SIZE);
+}
+
+struct LoadMatch {
+    GameState state;
+    bool awaitingAck = false;
+    std::chrono::steady_clock::time_point sentAt;
+};
+
+// Every connection plays random legal moves for the player side of all its
+// matches against the server's AI and times each move's acknowledgement,
+// the MOVE_PLAYED echo of our own move.
+int runLoadTest(const char* host, uint16_t port, int connectionCount, int matchesEach, int thinkMs, int gridSize) {
+    std::vector<NetClient> clients(connectionCount);
+    std::vector<std::map<uint64_t, LoadMatch>> matches(connectionCount);
+    Rules rules;
+    rules.gridSize = gridSize;
+    for (int c = 0; c < connectionCount; c++) {
+        if (!clients[c].connect(host, port)) {
+            std::fprintf(stderr, "cannot connect to %s:%u\n", host, static_cast<unsigned>(port));
+            return 1;
+        }
+        for (int m = 0; m < matchesEach; m++) clients[c].createMatch(rules, thinkMs);
+    }
+
+    std::mt19937 rng(1);
+    std::vector<double> acks;
+    long long finished = 0;
+    long long rejected = 0;
+    long long target = static_cast<long long>(connectionCount) * matchesEach;
+    auto start = std::chrono::steady_clock::now();
+    ServerEvent event;
+
+    while (finished + rejected < target && !stopRequested.load()) {
+        bool idle = true;
+        for (int c = 0; c < connectionCount; c++) {
+            if (!clients[c].poll(0)) {
+                std::fprintf(stderr, "connection %d lost\n", c);
+                return 1;
+            }
+            while (clients[c].nextEvent(event)) {
+                idle = false;
+                auto now = std::chrono::steady_clock::now();
+                switch (event.type) {
+                    case MessageType::MATCH_STARTED:
+                        matches[c][event.match].state.reset(event.rules);
+                        break;
+                    case MessageType::MOVE_PLAYED: {
+                        LoadMatch& match = matches[c][event.match];
+                        if (event.side == CellState::PLAYER && match.awaitingAck) {
+                            acks.push_back(std::chrono::duration<double, std::milli>(now - match.sentAt).count());
+                            match.awaitingAck = false;
+                        }
+                        applyMove(match.state, event.move);
+                        if (match.state.isOver()) {
+                            finished++;
+                            matches[c].erase(event.match);
+                        }
+                        break;
+                    }
+                    case MessageType::REJECTED:
+                        rejected++;
+                        matches[c].erase(event.match);
+                        break;
+                    default:
+                        break;
+                }
+            }
+            for (auto& entry : matches[c]) {
+                LoadMatch& match = entry.second;
+                if (match.awaitingAck || match.state.toMove != CellState::PLAYER || match.state.isOver()) continue;
+                clients[c].playMove(entry.first, match.state.turn, chooseRandomMove(match.state, rng));
+                match.awaitingAck = true;
+                match.sentAt = std::chrono::steady_clock::now();
+                idle = false;
+            }
+        }
+        if (idle) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::sort(acks.begin(), acks.end());
+    auto quantile = [&](double q) { return acks.empty() ? 0.0 : acks[std::min(acks.size() - 1, static_cast<size_t>(q * acks.size()))]; };
+    std::printf("%lld matches over %d connections in %.2fs, %lld rejected\n", finished, connectionCount, seconds, rejected);
+    std::printf("  %zu player moves acknowledged: p50 %.2f ms  p99 %.2f ms  max %.2f ms\n",
+                acks.size(), quantile(0.5), quantile(0.99), acks.empty() ? 0.0 : acks.back());
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+    const char* loadTestHost = nullptr;
+    int connections = 16;
+    int matchesEach = 64;
+    int thinkMs = 5;
+    int gridSize = DEFAULT_GRID_SIZE;
+    const char* tablebasePath = nullptr;
+    const char* telemetryPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", arg);
+            return 1;
+        }
+        const char* value = argv[++i];
+
+        if (std::strcmp(arg, "--port") == 0) config.port = static_cast<uint16_t>(std::atoi(value));
+        else if (std::strcmp(arg, "--max-matches") == 0) config.maxMatches = std::atoi(value);
+        else if (std::strcmp(arg, "--search-threads") == 0) config.searchThreads = std::atoi(value);
+        else if (std::strcmp(arg, "--max-think-ms") == 0) config.maxThinkMs = std::atoi(value);
+        else if (std::strcmp(arg, "--tablebase") == 0) tablebasePath = value;
+        else if (std::strcmp(arg, "--telemetry") == 0) telemetryPath = value;
+        else if (std::strcmp(arg, "--load-test") == 0) loadTestHost = value;
+        else if (std::strcmp(arg, "--connections") == 0) connections = std::atoi(value);
+        else if (std::strcmp(arg, "--matches") == 0) matchesEach = std::atoi(value);
+        else if (std::strcmp(arg, "--think-ms") == 0) thinkMs = std::atoi(value);
+        else if (std::strcmp(arg, "--size") == 0) gridSize = std::atoi(value);
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    if (loadTestHost) {
+        return runLoadTest(loadTestHost, config.port, std::max(1, connections), std::max(1, matchesEach),
+                           std::max(1, thinkMs), std::max(2, gridSize));
+    }
+
+    Tablebase tablebase;
+    if (tablebasePath) {
+        if (!tablebase.open(tablebasePath)) {
+            std::fprintf(stderr, "cannot read tablebase %s\n", tablebasePath);
+            return 1;
+        }
+        config.tablebase = &tablebase;
+    }
+
+    if (telemetryPath && !telemetry().start(telemetryPath)) {
+        std::fprintf(stderr, "cannot append to telemetry file %s\n", telemetryPath);
+        return 1;
+    }
+
+    GameServer server(config);
+    if (!server.start()) {
+        std::fprintf(stderr, "cannot listen on port %u\n", static_cast<unsigned>(config.port));
+        return 1;
+    }
+    std::printf("listening on port %u\n", static_cast<unsigned>(config.port));
+    std::fflush(stdout);
+
+    std::thread reporter([&] {
+        while (!stopRequested.load()) {
+            for (int tick = 0; tick < 50 && !stopRequested.load(); tick++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            ServerStats stats = server.stats();
+            std::printf("%lld connections, %lld matches, %lld moves, %lld searches\n",
+                        stats.connections, stats.matches, stats.movesPlayed, stats.searches);
+            std::fflush(stdout);
+        }
+    });
+    server.run(stopRequested);
+    reporter.join();
+    telemetry().stop();
+    return 0;
+}
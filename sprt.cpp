@@ -0,0 +1,225 @@
+#include "sprt.h"
+
+#include "random_ai.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+double expectedScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+double scoreToElo(double score) {
+    score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+// mean and variance of a pair's score, in [0, 1] steps of a quarter
+void pairMoments(const long long pairs[5], double& mean, double& variance, long long& count) {
+    count = 0;
+    double sum = 0.0;
+    for (int i = 0; i < 5; i++) {
+        count += pairs[i];
+        sum += pairs[i] * (i / 4.0);
+    }
+    mean = count > 0 ? sum / count : 0.5;
+    variance = 0.0;
+    for (int i = 0; i < 5; i++) variance += pairs[i] * (i / 4.0 - mean) * (i / 4.0 - mean);
+    variance = count > 0 ? variance / count : 0.0;
+}
+
+// The candidate's points, in half points, from one game it played as side.
+int halfPoints(GameResult outcome, CellState side) {
+    if (outcome == GameResult::DRAW || outcome == GameResult::NONE) return 1;
+    bool won = (outcome == GameResult::PLAYER_WIN) == (side == CellState::PLAYER);
+    return won ? 2 : 0;
+}
+
+struct PairCounters {
+    int points = 0;
+    int wins = 0;
+    int draws = 0;
+    double thinkSeconds[2] = {0.0, 0.0};
+    long long moves[2] = {0, 0};
+};
+
+// Plays opening then the agents to the end or to maxTurns, timing every
+// move against the side that chose it; candidateSide says which that is.
+GameResult playFromOpening(const SprtConfig& config, const Opening& opening, int maxTurns, Agent& candidate,
+                           Agent& baseline, CellState candidateSide, std::mt19937& rng, PairCounters& counters) {
+    GameState state;
+    state.reset(config.rules);
+    for (const Move& move : opening.moves) {
+        if (!applyMove(state, move)) break;
+    }
+    while (!state.isOver() && state.turn < maxTurns) {
+        bool candidateMoves = state.toMove == candidateSide;
+        Agent& agent = candidateMoves ? candidate : baseline;
+        auto start = std::chrono::steady_clock::now();
+        Move move = agent.chooseMove(state, rng);
+        counters.thinkSeconds[candidateMoves ? 0 : 1] +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        counters.moves[candidateMoves ? 0 : 1]++;
+        if (!applyMove(state, move)) applyPass(state);
+    }
+    return state.outcome;
+}
+
+}
+
+bool loadOpenings(const char* path, const Rules& rules, int plies, std::vector<Opening>& openings) {
+    ReplayMap log;
+    if (!log.open(path)) return false;
+    ReplayReader reader = log.reader();
+    if (!reader.valid()) return false;
+
+    ReplayGame game;
+    GameState state;
+    while (reader.next(game)) {
+        if (game.rules.gridSize != rules.gridSize || game.rules.impulseCost != rules.impulseCost ||
+            game.rules.winPercentage != rules.winPercentage || static_cast<int>(game.moves.size()) <= plies) {
+            continue;
+        }
+        state.reset(rules);
+        Opening opening;
+        for (int i = 0; i < plies && !state.isOver() && applyMove(state, game.moves[i]); i++) {
+            opening.moves.push_back(game.moves[i]);
+        }
+        if (static_cast<int>(opening.moves.size()) == plies && !state.isOver()) openings.push_back(opening);
+    }
+    return true;
+}
+
+std::vector<Opening> randomOpenings(const Rules& rules, int plies, int count, uint32_t seed) {
+    std::vector<Opening> openings;
+    std::mt19937 rng;
+    GameState state;
+    // a game already decided would score one win and one loss for either side
+    for (long long i = 0; static_cast<int>(openings.size()) < count && i < 100LL * count; i++) {
+        seedGame(rng, seed, i);
+        state.reset(rules);
+        Opening opening;
+        for (int ply = 0; ply < plies && !state.isOver(); ply++) {
+            Move move = chooseRandomMove(state, rng);
+            if (!applyMove(state, move)) break;
+            opening.moves.push_back(move);
+        }
+        if (!state.isOver()) openings.push_back(opening);
+    }
+    return openings;
+}
+
+double SprtResult::score() const {
+    double mean, variance;
+    long long count;
+    pairMoments(pairs, mean, variance, count);
+    return mean;
+}
+
+double SprtResult::elo() const {
+    return scoreToElo(score());
+}
+
+double SprtResult::eloMargin() const {
+    double mean, variance;
+    long long count;
+    pairMoments(pairs, mean, variance, count);
+    if (count < 2) return 0.0;
+    double spread = 1.96 * std::sqrt(variance / count);
+    return (scoreToElo(mean + spread) - scoreToElo(mean - spread)) / 2.0;
+}
+
+// The normal approximation to the GSPRT: with pair scores of mean m and
+// variance v over N pairs, LLR = N (s1 - s0) (2m - s0 - s1) / 2v.
+double pentanomialLlr(const long long pairs[5], double elo0, double elo1) {
+    double mean, variance;
+    long long count;
+    pairMoments(pairs, mean, variance, count);
+    if (count == 0 || variance <= 0.0) return 0.0;
+    double s0 = expectedScore(elo0);
+    double s1 = expectedScore(elo1);
+    return count * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+}
+
+SprtResult runSprt(const SprtConfig& config, const std::function<void(const SprtResult&)>& progress) {
+    ThreadPool& pool = config.pool ? *config.pool : sharedPool();
+    int threads = pool.concurrency();
+    int batch = config.batchPairs > 0 ? config.batchPairs : 4 * threads;
+    int maxTurns = config.maxTurns > 0 ? config.maxTurns : 4 * config.rules.gridSize * config.rules.gridSize;
+    const std::vector<Opening>& openings = *config.openings;
+
+    SprtResult result;
+    result.lowerBound = std::log(config.beta / (1.0 - config.alpha));
+    result.upperBound = std::log((1.0 - config.beta) / config.alpha);
+
+    struct alignas(64) Worker {
+        std::unique_ptr<Agent> candidate;
+        std::unique_ptr<Agent> baseline;
+    };
+    std::vector<Worker> workers(threads);
+    std::vector<PairCounters> counters;
+
+    auto start = std::chrono::steady_clock::now();
+    long long played = 0;
+    while (result.verdict == SprtVerdict::UNDECIDED && played < config.maxPairs) {
+        int pairs = static_cast<int>(std::min<long long>(batch, config.maxPairs - played));
+        counters.assign(pairs, PairCounters());
+        std::atomic<int> nextPair{0};
+
+        // agents live as long as their worker's thread slot, so tables they
+        // keep between moves carry over from pair to pair as in a match
+        pool.parallelFor(threads, [&](int id) {
+            Worker& worker = workers[id];
+            if (!worker.candidate) {
+                worker.candidate = config.candidate();
+                worker.baseline = config.baseline();
+            }
+            std::mt19937 rng;
+            for (int i = nextPair.fetch_add(1); i < pairs; i = nextPair.fetch_add(1)) {
+                long long pair = played + i;
+                const Opening& opening = openings[pair % openings.size()];
+                PairCounters& pairCounters = counters[i];
+                for (int game = 0; game < 2; game++) {
+                    CellState side = game == 0 ? CellState::PLAYER : CellState::AI;
+                    seedGame(rng, config.seed, 2 * pair + game);
+                    GameResult outcome = playFromOpening(config, opening, maxTurns, *worker.candidate,
+                                                         *worker.baseline, side, rng, pairCounters);
+                    int points = halfPoints(outcome, side);
+                    pairCounters.points += points;
+                    pairCounters.wins += points == 2;
+                    pairCounters.draws += points == 1;
+                }
+            }
+        });
+
+        for (const PairCounters& pair : counters) {
+            result.pairs[pair.points]++;
+            result.wins += pair.wins;
+            result.draws += pair.draws;
+            result.losses += 2 - pair.wins - pair.draws;
+            for (int s = 0; s < 2; s++) {
+                result.thinkSeconds[s] += pair.thinkSeconds[s];
+                result.moves[s] += pair.moves[s];
+            }
+        }
+        played += pairs;
+
+        result.nodes[0] = 0;
+        result.nodes[1] = 0;
+        for (const Worker& worker : workers) {
+            if (!worker.candidate) continue;
+            result.nodes[0] += worker.candidate->nodesSearched();
+            result.nodes[1] += worker.baseline->nodesSearched();
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.llr = pentanomialLlr(result.pairs, config.elo0, config.elo1);
+        if (result.llr >= result.upperBound) result.verdict = SprtVerdict::H1;
+        else if (result.llr <= result.lowerBound) result.verdict = SprtVerdict::H0;
+        if (progress) progress(result);
+    }
+    return result;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "tournament.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// A position both games of a pair start from: the first plies of a logged or
+// random game, replayed.
+struct Opening {
+    std::vector<Move> moves;
+};
+
+// The first plies moves of every game in the replay log at path played
+// under rules, skipping games that end or stop before then. False if the
+// log cannot be read.
+bool loadOpenings(const char* path, const Rules& rules, int plies, std::vector<Opening>& openings);
+
+// Up to count openings of plies random legal moves each, drawn from seed,
+// leaving out any that end the game; fewer only if nearly all of them do.
+std::vector<Opening> randomOpenings(const Rules& rules, int plies, int count, uint32_t seed);
+
+struct SprtConfig {
+    Rules rules;
+    double elo0 = -5.0;        // H0: the candidate is this much stronger (so negative = weaker)
+    double elo1 = 0.0;         // H1: ...or at least this much
+    double alpha = 0.05;       // chance of accepting H1 when H0 holds
+    double beta = 0.05;        // chance of accepting H0 when H1 holds
+    int maxPairs = 20000;      // stop undecided after this many game pairs
+    int batchPairs = 0;        // pairs played between checks, 0 = four per pool thread
+    int maxTurns = 0;          // 0 = four turns per cell; games cut off count as draws
+    uint32_t seed = 1;
+    ThreadPool* pool = nullptr;  // nullptr = sharedPool()
+    AgentFactory candidate;
+    AgentFactory baseline;
+    const std::vector<Opening>* openings = nullptr;  // cycled through; must not be empty
+};
+
+enum class SprtVerdict { UNDECIDED, H0, H1 };
+
+// Counts of game pairs by the candidate's points over the pair, 0 to 4 in
+// half points (0 = lost both, 2 = even, 4 = won both), and the time and
+// search effort each side spent choosing moves.
+struct SprtResult {
+    SprtVerdict verdict = SprtVerdict::UNDECIDED;
+    long long pairs[5] = {0, 0, 0, 0, 0};
+    long long wins = 0;
+    long long draws = 0;
+    long long losses = 0;
+    double llr = 0.0;
+    double lowerBound = 0.0;
+    double upperBound = 0.0;
+    double seconds = 0.0;
+    double thinkSeconds[2] = {0.0, 0.0};  // 0 = candidate, 1 = baseline
+    long long moves[2] = {0, 0};
+    long long nodes[2] = {0, 0};
+
+    long long pairCount() const { return pairs[0] + pairs[1] + pairs[2] + pairs[3] + pairs[4]; }
+    long long games() const { return 2 * pairCount(); }
+    // The candidate's mean score per game and the Elo it implies, with the
+    // half-width of a 95% interval around it.
+    double score() const;
+    double elo() const;
+    double eloMargin() const;
+    double nodesPerSecond(int side) const { return thinkSeconds[side] > 0 ? nodes[side] / thinkSeconds[side] : 0.0; }
+};
+
+// Log-likelihood ratio of H1 against H0 for the pair counts, by the
+// pentanomial model: each pair's score is one sample, so the correlation a
+// shared opening puts inside a pair does not inflate the evidence.
+double pentanomialLlr(const long long pairs[5], double elo0, double elo1);
+
+// Plays the candidate against the baseline in pairs, each game of a pair
+// from the same opening with the colours swapped, one batch at a time on
+// the pool, and stops at the first batch after which the LLR leaves
+// [log(beta / (1 - alpha)), log((1 - beta) / alpha)] or at maxPairs.
+// Pair i always starts from opening i % openings, with the seeds of games
+// 2i and 2i + 1, whichever thread plays it. progress, if given, is called
+// after every batch.
+SprtResult runSprt(const SprtConfig& config, const std::function<void(const SprtResult&)>& progress = nullptr);
@@ -0,0 +1,165 @@
+#include "agent_registry.h"
+#include "sprt.h"
+#include "tablebase.h"
+#include "thread_pool.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::printf("usage: %s --candidate NAME --baseline NAME [options]\n"
+                "  --candidate NAME    agent under test\n"
+                "  --baseline NAME     agent it must not fall behind\n"
+                "  --elo0 X            H0: candidate Elo advantage (default -5)\n"
+                "  --elo1 X            H1: candidate Elo advantage (default 0)\n"
+                "  --alpha X           false H1 rate (default 0.05)\n"
+                "  --beta X            false H0 rate (default 0.05)\n"
+                "  --max-pairs N       stop undecided after N game pairs (default 20000)\n"
+                "  --batch N           pairs between checks, 0 = 4 per thread (default 0)\n"
+                "  --openings FILE     opening positions from a replay log (default random)\n"
+                "  --opening-plies N   plies per opening (default 4)\n"
+                "  --max-slowdown PCT  also fail if the candidate searches PCT%% fewer nodes/s\n"
+                "  --threads N         pool threads, 0 = all cores (default 0)\n"
+                "  --size N            board size (default %d)\n"
+                "  --impulse-cost N    charges per impulse (default %d)\n"
+                "  --win-percentage N  share of the board needed to win (default %d)\n"
+                "  --max-turns N       turn cap per game, 0 = 4 per cell (default 0)\n"
+                "  --seed N            seed for openings and games (default 1)\n"
+                "  --tablebase FILE    MCTS agents play solved 7x7 endgames from it\n"
+                "exit status: 0 H1 accepted, 1 H0 accepted or too slow, 2 undecided\n"
+                "agents: %s\n",
+                program, DEFAULT_GRID_SIZE, IMPULSE_COST, WIN_PERCENTAGE, agentNames());
+}
+
+const int RANDOM_OPENINGS = 1000;
+
+void printProgress(const SprtResult& result) {
+    std::printf("pairs %lld  W-D-L %lld-%lld-%lld  elo %+.1f +- %.1f  LLR %.2f [%.2f, %.2f]\n",
+                result.pairCount(), result.wins, result.draws, result.losses, result.elo(), result.eloMargin(),
+                result.llr, result.lowerBound, result.upperBound);
+    std::fflush(stdout);
+}
+
+}
+
+// A non-regression gate for AI changes: with the defaults the candidate
+// passes once the games favour it being as strong as the baseline over it
+// being 5 Elo weaker, and fails on the reverse, usually long before a
+// fixed-length match would have finished.
+int main(int argc, char** argv) {
+    SprtConfig config;
+    std::string candidateName;
+    std::string baselineName;
+    const char* openingsPath = nullptr;
+    const char* tablebasePath = nullptr;
+    int openingPlies = 4;
+    int poolThreads = 0;
+    double maxSlowdown = -1.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", arg);
+            return 1;
+        }
+        const char* value = argv[++i];
+
+        if (std::strcmp(arg, "--candidate") == 0) candidateName = value;
+        else if (std::strcmp(arg, "--baseline") == 0) baselineName = value;
+        else if (std::strcmp(arg, "--elo0") == 0) config.elo0 = std::atof(value);
+        else if (std::strcmp(arg, "--elo1") == 0) config.elo1 = std::atof(value);
+        else if (std::strcmp(arg, "--alpha") == 0) config.alpha = std::atof(value);
+        else if (std::strcmp(arg, "--beta") == 0) config.beta = std::atof(value);
+        else if (std::strcmp(arg, "--max-pairs") == 0) config.maxPairs = std::atoi(value);
+        else if (std::strcmp(arg, "--batch") == 0) config.batchPairs = std::atoi(value);
+        else if (std::strcmp(arg, "--openings") == 0) openingsPath = value;
+        else if (std::strcmp(arg, "--opening-plies") == 0) openingPlies = std::atoi(value);
+        else if (std::strcmp(arg, "--max-slowdown") == 0) maxSlowdown = std::atof(value);
+        else if (std::strcmp(arg, "--threads") == 0) poolThreads = std::atoi(value);
+        else if (std::strcmp(arg, "--size") == 0) config.rules.gridSize = std::atoi(value);
+        else if (std::strcmp(arg, "--impulse-cost") == 0) config.rules.impulseCost = std::atoi(value);
+        else if (std::strcmp(arg, "--win-percentage") == 0) config.rules.winPercentage = std::atoi(value);
+        else if (std::strcmp(arg, "--max-turns") == 0) config.maxTurns = std::atoi(value);
+        else if (std::strcmp(arg, "--seed") == 0) config.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--tablebase") == 0) tablebasePath = value;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (config.rules.gridSize < 2 || config.maxPairs < 1 || openingPlies < 0 || config.elo1 <= config.elo0 ||
+        config.alpha <= 0.0 || config.alpha >= 1.0 || config.beta <= 0.0 || config.beta >= 1.0) {
+        std::fprintf(stderr, "need --size >= 2, --max-pairs >= 1, --elo1 > --elo0 and alpha, beta in (0, 1)\n");
+        return 1;
+    }
+
+    Tablebase tablebase;
+    if (tablebasePath && !tablebase.open(tablebasePath)) {
+        std::fprintf(stderr, "cannot read tablebase %s\n", tablebasePath);
+        return 1;
+    }
+    const Tablebase* solved = tablebase.loaded() ? &tablebase : nullptr;
+    config.candidate = findAgent(candidateName, solved);
+    config.baseline = findAgent(baselineName, solved);
+    if (!config.candidate || !config.baseline) {
+        std::fprintf(stderr, "need a known --candidate and --baseline; agents: %s\n", agentNames());
+        return 1;
+    }
+
+    std::vector<Opening> openings;
+    if (openingsPath) {
+        if (!loadOpenings(openingsPath, config.rules, openingPlies, openings)) {
+            std::fprintf(stderr, "cannot read replay log %s\n", openingsPath);
+            return 1;
+        }
+        if (openings.empty()) {
+            std::fprintf(stderr, "%s has no %dx%d games longer than %d plies\n", openingsPath,
+                         config.rules.gridSize, config.rules.gridSize, openingPlies);
+            return 1;
+        }
+    } else {
+        openings = randomOpenings(config.rules, openingPlies, RANDOM_OPENINGS, config.seed);
+        if (openings.empty()) {
+            std::fprintf(stderr, "every random %d-ply opening ends the game; use fewer --opening-plies\n", openingPlies);
+            return 1;
+        }
+    }
+    config.openings = &openings;
+
+    setSharedPoolThreads(poolThreads);
+    std::printf("%s vs %s, %dx%d, %zu openings of %d plies, H0 elo %+.1f  H1 elo %+.1f  alpha %.3f  beta %.3f\n",
+                candidateName.c_str(), baselineName.c_str(), config.rules.gridSize, config.rules.gridSize,
+                openings.size(), openingPlies, config.elo0, config.elo1, config.alpha, config.beta);
+    SprtResult result = runSprt(config, printProgress);
+
+    const char* verdicts[3] = {"undecided", "H0 accepted: regression", "H1 accepted: no regression"};
+    std::printf("%s after %lld games in %.2fs (%.1f games/s)\n", verdicts[static_cast<int>(result.verdict)],
+                result.games(), result.seconds, result.seconds > 0 ? result.games() / result.seconds : 0.0);
+    std::printf("  pairs by candidate points 0/0.5/1/1.5/2: %lld %lld %lld %lld %lld\n", result.pairs[0],
+                result.pairs[1], result.pairs[2], result.pairs[3], result.pairs[4]);
+    const std::string* names[2] = {&candidateName, &baselineName};
+    for (int s = 0; s < 2; s++) {
+        std::printf("  %-9s %-16s %8.2f ms/move  %12.0f nodes/s\n", s == 0 ? "candidate" : "baseline",
+                    names[s]->c_str(), result.moves[s] > 0 ? 1000.0 * result.thinkSeconds[s] / result.moves[s] : 0.0,
+                    result.nodesPerSecond(s));
+    }
+
+    if (maxSlowdown >= 0.0 && result.nodesPerSecond(0) > 0 && result.nodesPerSecond(1) > 0 &&
+        result.nodesPerSecond(0) < result.nodesPerSecond(1) * (1.0 - maxSlowdown / 100.0)) {
+        std::printf("  speed regression: candidate searches %.1f%% fewer nodes/s\n",
+                    100.0 * (1.0 - result.nodesPerSecond(0) / result.nodesPerSecond(1)));
+        return 1;
+    }
+    if (result.verdict == SprtVerdict::H1) return 0;
+    return result.verdict == SprtVerdict::H0 ? 1 : 2;
+}
@@ -0,0 +1,246 @@
+#include "tablebase.h"
+
+#include "fixed_board.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using Game = FixedGame<TABLEBASE_GRID_SIZE>;
+using GameBoard = FixedBoard<TABLEBASE_GRID_SIZE>;
+
+const uint8_t MAGIC[4] = {'T', 'T', 'B', '7'};
+const uint32_t VERSION = 1;
+const size_t HEADER_BYTES = 40;
+const uint32_t OCCUPIED = uint32_t(1) << 31;  // set in every stored value, so an empty slot is 0
+
+uint32_t pack(const SolvedPosition& solved) {
+    uint32_t bits = static_cast<uint32_t>(solved.value) | (static_cast<uint32_t>(solved.best.type) << 2) |
+                    (static_cast<uint32_t>(solved.best.count) << 4);
+    for (int i = 0; i < solved.best.count; i++) {
+        bits |= static_cast<uint32_t>(solved.best.cells[i]) << (6 + 6 * i);
+    }
+    return bits;
+}
+
+SolvedPosition unpack(uint32_t bits) {
+    SolvedPosition solved;
+    solved.value = static_cast<SolvedValue>(bits & 3);
+    solved.best.type = static_cast<MoveType>((bits >> 2) & 3);
+    solved.best.count = static_cast<uint8_t>((bits >> 4) & 3);
+    for (int i = 0; i < solved.best.count; i++) {
+        solved.best.cells[i] = static_cast<int>((bits >> (6 + 6 * i)) & 63);
+    }
+    return solved;
+}
+
+SolvedValue valueFor(GameResult outcome, CellState side) {
+    if (outcome == GameResult::DRAW) return SolvedValue::DRAW;
+    bool won = (outcome == GameResult::PLAYER_WIN) == (side == CellState::PLAYER);
+    return won ? SolvedValue::WIN : SolvedValue::LOSS;
+}
+
+SolvedValue flip(SolvedValue value) {
+    return static_cast<SolvedValue>(2 - static_cast<int>(value));
+}
+
+int bitsOf(const GameBoard::Mask& mask, int* out) {
+    int count = 0;
+    for (int w = 0; w < GameBoard::WORDS; w++) {
+        for (uint64_t word = mask[w]; word != 0; word &= word - 1) out[count++] = w * 64 + lowestBit(word);
+    }
+    return count;
+}
+
+int neutralCells(const GameState& state) {
+    return state.board.cellCount() - state.board.count(CellState::PLAYER) - state.board.count(CellState::AI);
+}
+
+uint32_t readU32(const uint8_t* bytes) {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+}
+
+bool EndgameSolver::solve(const GameState& state, SolvedPosition& solved) {
+    if (state.rules.gridSize != TABLEBASE_GRID_SIZE || state.rules.impulseCost < 1 || state.isOver()) return false;
+    Game game;
+    game.load(state);
+    nodes = 0;
+    aborted = false;
+    uint32_t bits = search(game);
+    if (aborted) return false;
+    solved = unpack(bits);
+    return true;
+}
+
+uint32_t EndgameSolver::search(const Game& game) {
+    uint64_t key = game.hash();
+    auto known = solvedPositions.find(key);
+    if (known != solvedPositions.end()) return known->second;
+    if (nodeLimit > 0 && ++nodes > nodeLimit) {
+        aborted = true;
+        return 0;
+    }
+
+    SolvedPosition best;
+    best.value = SolvedValue::LOSS;
+    bool tried = false;
+    bool won = false;
+    // once a win is found or the search is abandoned there is nothing left to learn here
+    auto tryMove = [&](const Move& move) {
+        Game child = game;
+        child.applyMove(move);
+        SolvedValue value = child.isOver() ? valueFor(child.outcome, game.toMove)
+                                           : flip(unpack(search(child)).value);
+        if (aborted) return;
+        if (!tried || value > best.value) {
+            best.value = value;
+            best.best = move;
+            tried = true;
+        }
+        won = value == SolvedValue::WIN;
+    };
+
+    int frontier[GameBoard::CELLS];
+    int frontierCount = bitsOf(game.targets(MoveType::CAPTURE), frontier);
+    // captures, then the largest impulses: the likelier wins come first
+    for (int i = 0; i < frontierCount && !won && !aborted; i++) {
+        tryMove(Move::capture(frontier[i]));
+    }
+    if (game.canUseImpulse(game.toMove)) {
+        int contested[GameBoard::CELLS];
+        int contestedCount = bitsOf(game.targets(MoveType::ATTACK), contested);
+        Move move;
+        move.type = MoveType::SPEED;
+        move.count = 3;
+        for (int i = 0; i < frontierCount && !won && !aborted; i++) {
+            for (int j = i + 1; j < frontierCount && !won && !aborted; j++) {
+                for (int k = j + 1; k < frontierCount && !won && !aborted; k++) {
+                    move.cells[0] = frontier[i];
+                    move.cells[1] = frontier[j];
+                    move.cells[2] = frontier[k];
+                    tryMove(move);
+                }
+            }
+        }
+        move.type = MoveType::ATTACK;
+        move.count = 2;
+        for (int i = 0; i < contestedCount && !won && !aborted; i++) {
+            for (int j = i + 1; j < contestedCount && !won && !aborted; j++) {
+                move.cells[0] = contested[i];
+                move.cells[1] = contested[j];
+                tryMove(move);
+            }
+        }
+        move.type = MoveType::SPEED;
+        move.cells[2] = -1;
+        for (int i = 0; i < frontierCount && !won && !aborted; i++) {
+            for (int j = i + 1; j < frontierCount && !won && !aborted; j++) {
+                move.cells[0] = frontier[i];
+                move.cells[1] = frontier[j];
+                tryMove(move);
+            }
+        }
+        move.count = 1;
+        move.cells[1] = -1;
+        for (int i = 0; i < frontierCount && !won && !aborted; i++) {
+            move.cells[0] = frontier[i];
+            tryMove(move);
+        }
+        move.type = MoveType::ATTACK;
+        for (int i = 0; i < contestedCount && !won && !aborted; i++) {
+            move.cells[0] = contested[i];
+            tryMove(move);
+        }
+    }
+    if (!tried && !aborted) tryMove(Move::pass());
+    if (aborted) return 0;
+
+    uint32_t bits = pack(best);
+    solvedPositions.emplace(key, bits);
+    return bits;
+}
+
+bool writeTablebase(const char* path, const Rules& rules, int maxNeutrals, const EndgameSolver& solver) {
+    const std::unordered_map<uint64_t, uint32_t>& positions = solver.positions();
+    uint32_t slotBits = 4;
+    while ((uint64_t(1) << slotBits) < 2 * positions.size()) slotBits++;
+    uint64_t slots = uint64_t(1) << slotBits;
+    uint64_t mask = slots - 1;
+
+    std::vector<uint64_t> table(slots, 0);
+    for (const auto& position : positions) {
+        uint64_t slot = position.first & mask;
+        while (table[slot] != 0) slot = (slot + 1) & mask;
+        table[slot] = (position.first & ~uint64_t(0xffffffff)) | position.second | OCCUPIED;
+    }
+    uint64_t stored = positions.size();
+
+    uint8_t header[HEADER_BYTES] = {};
+    uint32_t fields[6] = {VERSION, static_cast<uint32_t>(rules.gridSize), static_cast<uint32_t>(rules.impulseCost),
+                          static_cast<uint32_t>(rules.winPercentage), static_cast<uint32_t>(maxNeutrals), slotBits};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    std::memcpy(header + 4, fields, sizeof(fields));
+    std::memcpy(header + 32, &stored, sizeof(stored));
+
+    FILE* out = std::fopen(path, "wb");
+    if (!out) return false;
+    bool ok = std::fwrite(header, 1, HEADER_BYTES, out) == HEADER_BYTES &&
+              std::fwrite(table.data(), sizeof(uint64_t), table.size(), out) == table.size();
+    return std::fclose(out) == 0 && ok;
+}
+
+bool Tablebase::open(const char* path) {
+    close();
+    if (!file.open(path, MapAccess::RANDOM)) return false;
+    const uint8_t* bytes = file.data();
+    if (file.size() < HEADER_BYTES || std::memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0 ||
+        readU32(bytes + 4) != VERSION || readU32(bytes + 8) != TABLEBASE_GRID_SIZE) {
+        close();
+        return false;
+    }
+
+    uint32_t slotBits = readU32(bytes + 24);
+    uint64_t slots = uint64_t(1) << slotBits;
+    if (slotBits > 40 || file.size() != HEADER_BYTES + slots * sizeof(uint64_t)) {
+        close();
+        return false;
+    }
+    rules.gridSize = TABLEBASE_GRID_SIZE;
+    rules.impulseCost = static_cast<int>(readU32(bytes + 12));
+    rules.winPercentage = static_cast<int>(readU32(bytes + 16));
+    maxNeutrals = static_cast<int>(readU32(bytes + 20));
+    std::memcpy(&count, bytes + 32, sizeof(count));
+    mask = slots - 1;
+    // the header is a multiple of 8 bytes and mappings are page aligned
+    table = reinterpret_cast<const uint64_t*>(bytes + HEADER_BYTES);
+    return true;
+}
+
+void Tablebase::close() {
+    file.close();
+    table = nullptr;
+    count = 0;
+}
+
+bool Tablebase::probe(const GameState& state, SolvedPosition& solved) const {
+    if (!table || state.isOver() || state.rules.gridSize != rules.gridSize ||
+        state.rules.impulseCost != rules.impulseCost || state.rules.winPercentage != rules.winPercentage ||
+        neutralCells(state) > maxNeutrals) {
+        return false;
+    }
+
+    uint64_t key = state.hash();
+    uint64_t check = key >> 32;
+    for (uint64_t slot = key & mask; table[slot] != 0; slot = (slot + 1) & mask) {
+        if (table[slot] >> 32 == check) {
+            solved = unpack(static_cast<uint32_t>(table[slot]) & ~OCCUPIED);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "rules.h"
+#include <cstdint>
+#include <unordered_map>
+
+template <int N>
+struct FixedGame;
+
+const int TABLEBASE_GRID_SIZE = 7;
+const int DEFAULT_TABLEBASE_NEUTRALS = 7;
+
+// Game-theoretic value for the side to move, with both sides playing perfectly.
+enum class SolvedValue : uint8_t { LOSS, DRAW, WIN };
+
+struct SolvedPosition {
+    SolvedValue value = SolvedValue::DRAW;
+    Move best;  // a move that keeps value; PASS only when nothing else is legal
+};
+
+// Exact solver for 7x7 positions: minimax over every legal move, every
+// subset of targets an impulse may take included, memoised by Zobrist key.
+// It terminates because captures and speed impulses use up neutral cells,
+// attacks use up charges that only captures earn, and a round in which
+// neither side can do anything seals the game. The only cutoff is stopping
+// at the first winning move, so every memoised value is exact and safe to
+// publish. One solver serves one set of rules.
+class EndgameSolver {
+public:
+    // nodeLimit caps how many new positions one solve() may visit; 0 = no cap.
+    explicit EndgameSolver(long long nodeLimit = 0) : nodeLimit(nodeLimit) {}
+
+    // False if state is not 7x7, its rules make impulses free (the argument
+    // above needs them to cost a charge) or solving it ran past the node
+    // limit; the positions finished before that stay solved either way.
+    bool solve(const GameState& state, SolvedPosition& solved);
+
+    // Every position solved so far, by key, packed as in the file.
+    const std::unordered_map<uint64_t, uint32_t>& positions() const { return solvedPositions; }
+
+private:
+    uint32_t search(const FixedGame<TABLEBASE_GRID_SIZE>& game);
+
+    std::unordered_map<uint64_t, uint32_t> solvedPositions;
+    long long nodeLimit;
+    long long nodes = 0;
+    bool aborted = false;
+};
+
+// Writes solver's positions as a tablebase for rules, covering positions with
+// at most maxNeutrals neutral cells. Little-endian, like every target we ship.
+//
+//   header   "TTB7" then u32 version gridSize impulseCost winPercentage
+//            maxNeutrals slotBits, padding, and the u64 position count at 32
+//   slots    u64 each, open addressing with linear probing from key's low
+//            bits. The high half holds key's high 32 bits as the check, the
+//            low half an occupied bit (so 0 = empty), the value, move type,
+//            count and three 6-bit cells.
+bool writeTablebase(const char* path, const Rules& rules, int maxNeutrals, const EndgameSolver& solver);
+
+// A tablebase file mapped read-only. probe() is a hash and a short probe run
+// in place, without loading anything into memory first. Two positions whose
+// keys share the check bits and a probe run would read as one; at 32 check
+// bits on top of the slot index that is far below a playing concern.
+class Tablebase {
+public:
+    bool open(const char* path);
+    void close();
+    bool loaded() const { return table != nullptr; }
+    uint64_t size() const { return count; }
+
+    // True, with solved filled in, if state is in the table: same rules,
+    // 7x7, at most maxNeutrals neutral cells and a position the generator
+    // reached.
+    bool probe(const GameState& state, SolvedPosition& solved) const;
+
+private:
+    MappedFile file;
+    Rules rules;
+    int maxNeutrals = 0;
+    uint64_t count = 0;
+    uint64_t mask = 0;
+    const uint64_t* table = nullptr;
+};
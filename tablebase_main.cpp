@@ -0,0 +1,153 @@
+#include "random_ai.h"
+#include "replay.h"
+#include "tablebase.h"
+#include "tournament.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::printf("usage: %s [options]\n"
+                "  --out FILE          tablebase to write (default tablebase7.bin)\n"
+                "  --games N           self-play games to draw endgames from (default 500)\n"
+                "  --from FILE         also solve the endgames of a replay log's 7x7 games\n"
+                "  --max-neutrals N    solve positions with at most N neutral cells (default %d)\n"
+                "  --node-limit N      give up on a position after N new nodes, 0 = never (default 2000000)\n"
+                "  --impulse-cost N    charges per impulse (default %d)\n"
+                "  --win-percentage N  share of the board needed to win (default %d)\n"
+                "  --seed N            self-play seed (default 1)\n",
+                program, DEFAULT_TABLEBASE_NEUTRALS, IMPULSE_COST, WIN_PERCENTAGE);
+}
+
+int neutralCells(const GameState& state) {
+    return state.board.cellCount() - state.board.count(CellState::PLAYER) - state.board.count(CellState::AI);
+}
+
+struct Progress {
+    long long solved = 0;
+    long long abandoned = 0;
+    long long outcomes[3] = {0, 0, 0};
+};
+
+void solveEndgame(EndgameSolver& solver, const GameState& state, int maxNeutrals, Progress& progress) {
+    if (state.isOver() || neutralCells(state) > maxNeutrals) return;
+    SolvedPosition solved;
+    if (solver.solve(state, solved)) {
+        progress.solved++;
+        progress.outcomes[static_cast<int>(solved.value)]++;
+    } else {
+        progress.abandoned++;
+    }
+}
+
+}
+
+// The solver searches forward from each position it is given; this tool only
+// chooses which positions it starts from. It plays random self-play games on 7x7, and replays the
+// matching games of --from logs, and solves every position along them once
+// few enough neutral cells are left; each solve also publishes every
+// position below it that the solver had to settle. Logs recorded from real
+// play (terra --record) steer the table towards positions people reach.
+int main(int argc, char** argv) {
+    const char* outPath = "tablebase7.bin";
+    int games = 500;
+    int maxNeutrals = DEFAULT_TABLEBASE_NEUTRALS;
+    long long nodeLimit = 2000000;
+    uint32_t seed = 1;
+    const char* fromPath = nullptr;
+    Rules rules;
+    rules.gridSize = TABLEBASE_GRID_SIZE;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", arg);
+            return 1;
+        }
+        const char* value = argv[++i];
+
+        if (std::strcmp(arg, "--out") == 0) outPath = value;
+        else if (std::strcmp(arg, "--games") == 0) games = std::atoi(value);
+        else if (std::strcmp(arg, "--from") == 0) fromPath = value;
+        else if (std::strcmp(arg, "--max-neutrals") == 0) maxNeutrals = std::atoi(value);
+        else if (std::strcmp(arg, "--node-limit") == 0) nodeLimit = std::atoll(value);
+        else if (std::strcmp(arg, "--impulse-cost") == 0) rules.impulseCost = std::atoi(value);
+        else if (std::strcmp(arg, "--win-percentage") == 0) rules.winPercentage = std::atoi(value);
+        else if (std::strcmp(arg, "--seed") == 0) seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // free impulses let attacks trade cells back and forth forever, so the
+    // solver's search would never bottom out
+    if (rules.impulseCost < 1) {
+        std::fprintf(stderr, "need --impulse-cost >= 1\n");
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    EndgameSolver solver(nodeLimit);
+    std::mt19937 rng;
+    GameState state;
+    Progress progress;
+
+    if (fromPath) {
+        ReplayMap log;
+        if (!log.open(fromPath) || !log.reader().valid()) {
+            std::fprintf(stderr, "cannot read replay log %s\n", fromPath);
+            return 1;
+        }
+        ReplayReader reader = log.reader();
+        ReplayGame game;
+        long long used = 0;
+        while (reader.next(game)) {
+            const Rules& played = game.rules;
+            if (played.gridSize != rules.gridSize || played.impulseCost != rules.impulseCost ||
+                played.winPercentage != rules.winPercentage) {
+                continue;
+            }
+            state.reset(rules);
+            for (const Move& move : game.moves) {
+                solveEndgame(solver, state, maxNeutrals, progress);
+                if (!applyMove(state, move)) break;
+            }
+            used++;
+        }
+        std::printf("%lld logged games, %zu positions\n", used, solver.positions().size());
+    }
+
+    for (int game = 0; game < games; game++) {
+        seedGame(rng, seed, game);
+        state.reset(rules);
+        while (!state.isOver()) {
+            solveEndgame(solver, state, maxNeutrals, progress);
+            if (!applyMove(state, chooseRandomMove(state, rng))) applyPass(state);
+        }
+        if ((game + 1) % 100 == 0) {
+            std::printf("%d games, %zu positions\n", game + 1, solver.positions().size());
+            std::fflush(stdout);
+        }
+    }
+
+    if (!writeTablebase(outPath, rules, maxNeutrals, solver)) {
+        std::fprintf(stderr, "cannot write %s\n", outPath);
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu positions written to %s in %.1fs\n", solver.positions().size(), outPath, seconds);
+    std::printf("  %lld game positions solved (win %lld, draw %lld, loss %lld for the side to move), %lld over the node limit\n",
+                progress.solved, progress.outcomes[2], progress.outcomes[1], progress.outcomes[0],
+                progress.abandoned);
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "telemetry.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+const int DRAIN_INTERVAL_MS = 100;
+const uint64_t FRAME_WINDOW_NS = 1000000000;  // one summary line per second of frames
+const int MAX_WINDOW_FRAMES = 4096;           // frames beyond this in a window are not summarised
+
+const char* EVENT_NAMES[] = {"terra_frame", "terra_turn", "terra_search", "terra_impulse", "terra_match_end",
+                             "terra_audio_underrun"};
+
+uint64_t unixNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+}
+
+Telemetry::Telemetry(int capacity) {
+    uint64_t size = 1;
+    while (size < static_cast<uint64_t>(std::max(2, capacity))) size <<= 1;
+    slots.reset(new Slot[size]);
+    for (uint64_t i = 0; i < size; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+    mask = size - 1;
+    frames.reset(new uint64_t[MAX_WINDOW_FRAMES]);
+}
+
+bool Telemetry::start(const char* path) {
+    stop();
+    out = std::fopen(path, "ab");
+    if (!out) return false;
+    frameCount = 0;
+    windowStart = unixNanos();
+    active.store(true);
+    drainer = std::thread(&Telemetry::drainLoop, this);
+    return true;
+}
+
+void Telemetry::stop() {
+    if (!active.exchange(false)) return;
+    drainer.join();
+    drain();
+    flushFrames(unixNanos());
+    std::fprintf(out, "terra_telemetry dropped=%lldi %llu\n", dropped(), static_cast<unsigned long long>(unixNanos()));
+    std::fclose(out);
+    out = nullptr;
+}
+
+// Vyukov's bounded queue: a slot whose sequence equals the claimed position
+// is free, its position + 1 full, and the drainer hands it back a lap later.
+void Telemetry::record(const TelemetrySample& sample) {
+    uint64_t position = head.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[position & mask];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t lag = static_cast<int64_t>(sequence - position);
+        if (lag == 0) {
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if (lag < 0) {
+            droppedSamples.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+    slot->sample = sample;
+    slot->sample.time = unixNanos();
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void Telemetry::drainLoop() {
+    while (active.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+        drain();
+        std::fflush(out);
+    }
+}
+
+void Telemetry::drain() {
+    while (true) {
+        Slot& slot = slots[tail & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) break;
+        TelemetrySample sample = slot.sample;
+        slot.sequence.store(tail + mask + 1, std::memory_order_release);
+        tail++;
+        write(sample);
+    }
+    flushFrames(unixNanos());
+}
+
+void Telemetry::write(const TelemetrySample& sample) {
+    if (sample.event == TelemetryEvent::FRAME) {
+        if (frameCount < MAX_WINDOW_FRAMES) frames[frameCount++] = sample.value;
+        return;
+    }
+    std::fprintf(out, "%s,side=%u match=%llui,turn=%ui,value=%llui,count=%llui,detail=%ui %llu\n",
+                 EVENT_NAMES[static_cast<int>(sample.event)], static_cast<unsigned>(sample.side),
+                 static_cast<unsigned long long>(sample.match), static_cast<unsigned>(sample.turn),
+                 static_cast<unsigned long long>(sample.value), static_cast<unsigned long long>(sample.count),
+                 static_cast<unsigned>(sample.detail), static_cast<unsigned long long>(sample.time));
+}
+
+void Telemetry::flushFrames(uint64_t now) {
+    if (now - windowStart < FRAME_WINDOW_NS && active.load()) return;
+    if (frameCount > 0) {
+        uint64_t* first = frames.get();
+        uint64_t* last = first + frameCount;
+        std::sort(first, last);
+        auto quantile = [&](double q) { return first[std::min(frameCount - 1, static_cast<int>(q * frameCount))]; };
+        std::fprintf(out, "terra_frames count=%di,p50=%llui,p99=%llui,max=%llui %llu\n", frameCount,
+                     static_cast<unsigned long long>(quantile(0.5)), static_cast<unsigned long long>(quantile(0.99)),
+                     static_cast<unsigned long long>(last[-1]), static_cast<unsigned long long>(now));
+    }
+    frameCount = 0;
+    windowStart = now;
+}
+
+Telemetry& telemetry() {
+    static Telemetry sink;
+    return sink;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+enum class TelemetryEvent : uint8_t { FRAME, TURN, SEARCH, IMPULSE, MATCH_END, AUDIO_UNDERRUN };
+
+// One fixed-size sample. What value, count and detail hold depends on event:
+//   FRAME           value = frame time in ns
+//   TURN            value = ns from the turn starting to its move landing
+//   SEARCH          value = think time in ns, count = tree nodes
+//   IMPULSE         detail = move type, count = cells taken
+//   MATCH_END       detail = game result
+//   AUDIO_UNDERRUN  value = ns the music stream went without being fed
+struct TelemetrySample {
+    TelemetryEvent event = TelemetryEvent::FRAME;
+    uint8_t side = 0;
+    uint16_t detail = 0;
+    uint32_t turn = 0;
+    uint64_t match = 0;
+    uint64_t value = 0;
+    uint64_t count = 0;
+    uint64_t time = 0;  // unix ns, stamped by record()
+};
+
+// Metrics sink for the client, the server and their AI workers. record() is
+// a slot claim on a bounded multi-producer ring and a copy: no lock, no
+// allocation, no system call, and when the ring is full the sample is
+// dropped and counted rather than waited for. A background thread drains
+// the ring a few times a second and appends it to a file in InfluxDB line
+// protocol, one line per sample, except that FRAME samples are folded into
+// one p50/p99/max line per second.
+class Telemetry {
+public:
+    static const int DEFAULT_CAPACITY = 1 << 14;  // samples; rounded up to a power of two
+
+    explicit Telemetry(int capacity = DEFAULT_CAPACITY);
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+    ~Telemetry() { stop(); }
+
+    // Appends to path; false if it cannot be opened. Nothing is recorded
+    // before start() or after stop().
+    bool start(const char* path);
+    // Drains what is left, writes the dropped count and closes the file.
+    void stop();
+    bool running() const { return active.load(std::memory_order_relaxed); }
+
+    void record(const TelemetrySample& sample);
+    long long dropped() const { return droppedSamples.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        TelemetrySample sample;
+    };
+
+    void drainLoop();
+    void drain();
+    void write(const TelemetrySample& sample);
+    void flushFrames(uint64_t now);
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask;
+    alignas(64) std::atomic<uint64_t> head{0};  // next slot a producer claims
+    alignas(64) uint64_t tail = 0;              // next slot the drainer reads
+    std::atomic<bool> active{false};
+    std::atomic<long long> droppedSamples{0};
+
+    std::thread drainer;
+    FILE* out = nullptr;
+    std::unique_ptr<uint64_t[]> frames;  // frame times since the last summary line
+    int frameCount = 0;
+    uint64_t windowStart = 0;
+};
+
+// The process-wide sink every recording site shares; it records nothing
+// until someone calls start() on it.
+Telemetry& telemetry();
+
+// Records a sample if telemetry() is running. Costs one relaxed load when
+// it is not.
+inline void recordTelemetry(const TelemetrySample& sample) {
+    Telemetry& sink = telemetry();
+    if (sink.running()) sink.record(sample);
+}
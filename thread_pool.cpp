@@ -0,0 +1,150 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// which pool, if any, the current thread works for, and its deque there
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentQueue = 0;
+
+std::atomic<int> sharedThreads{0};
+std::atomic<bool> sharedStarted{false};
+
+}
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, threads);
+
+    for (int i = 0; i < threads; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (int id = 0; id + 1 < threads; id++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, id);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::homeQueue() const {
+    return currentPool == this ? currentQueue : static_cast<int>(workers.size());
+}
+
+bool ThreadPool::takeTask(int home, Task& task) {
+    if (queued.load(std::memory_order_acquire) == 0) return false;
+
+    {
+        Queue& own = *queues[home];
+        std::lock_guard<std::mutex> lock(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    int count = static_cast<int>(queues.size());
+    for (int offset = 1; offset < count; offset++) {
+        Queue& victim = *queues[(home + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::takeBatchTask(int home, const Batch& batch, Task& task) {
+    // thieves only ever run the tasks they take, so whatever is left of the
+    // batch is still on the caller's deque, under any other outside caller's
+    Queue& own = *queues[home];
+    std::lock_guard<std::mutex> lock(own.lock);
+    for (auto it = own.tasks.rbegin(); it != own.tasks.rend(); ++it) {
+        if (it->batch != &batch) continue;
+        task = *it;
+        own.tasks.erase(std::next(it).base());
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::runTask(const Task& task) {
+    (*task.batch->body)(task.index);
+    // the batch lives on its caller's stack and may be gone once this lands
+    task.batch->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& body) {
+    if (count <= 0) return;
+    if (count == 1 || workers.empty()) {
+        for (int i = 0; i < count; i++) body(i);
+        return;
+    }
+
+    Batch batch{&body, {count}};
+    int home = homeQueue();
+    {
+        Queue& own = *queues[home];
+        std::lock_guard<std::mutex> lock(own.lock);
+        // pushed in reverse so the caller's own pops run them in order
+        for (int i = count - 1; i >= 1; i--) {
+            own.tasks.push_back(Task{&batch, i});
+        }
+    }
+    queued.fetch_add(count - 1, std::memory_order_release);
+    {
+        // taking the lock orders this wake-up after any worker's last look at queued
+        std::lock_guard<std::mutex> lock(sleepLock);
+    }
+    if (count - 1 >= static_cast<int>(workers.size())) wake.notify_all();
+    else for (int i = 0; i < count - 1; i++) wake.notify_one();
+
+    runTask(Task{&batch, 0});
+    Task task;
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (takeBatchTask(home, batch, task)) runTask(task);
+        else std::this_thread::yield();
+    }
+}
+
+void ThreadPool::workerLoop(int id) {
+    currentPool = this;
+    currentQueue = id;
+    Task task;
+    while (true) {
+        if (takeTask(id, task)) {
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepLock);
+        wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping && queued.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+ThreadPool& sharedPool() {
+    static ThreadPool pool((sharedStarted.store(true), sharedThreads.load()));
+    return pool;
+}
+
+bool setSharedPoolThreads(int threads) {
+    if (sharedStarted.load()) return false;
+    sharedThreads.store(threads);
+    return true;
+}
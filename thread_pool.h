@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool that the AI search and the tournament runner share
+// instead of each starting threads of their own. Each worker keeps a deque of
+// tasks: it pops its own newest task and, when that runs dry, steals the
+// oldest from another worker. Threads outside the pool queue work on one
+// extra deque that every worker also steals from.
+//
+// parallelFor() blocks its caller but never idles it while its batch still
+// has tasks queued: the caller runs those itself, then waits out the ones
+// other threads took. It only ever runs its own batch's tasks, never another
+// caller's, so a search waiting on its trees cannot pick up a whole
+// tournament game and overrun its deadline. That makes nesting safe, so a
+// tournament game running on a worker can split its own search across the
+// pool, and it is why a pool of one thread simply runs every batch inline.
+class ThreadPool {
+public:
+    // threads counts the calling thread too: 1 starts no workers at all,
+    // 0 means one per hardware thread.
+    explicit ThreadPool(int threads = 0);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    // Workers plus the caller: how many tasks can run at once.
+    int concurrency() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Runs body(0) .. body(count - 1) across the pool, body(0) on the calling
+    // thread, and returns once every call has returned.
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+private:
+    struct Batch {
+        const std::function<void(int)>* body;
+        std::atomic<int> remaining;
+    };
+
+    struct Task {
+        Batch* batch;
+        int index;
+    };
+
+    struct alignas(64) Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    int homeQueue() const;
+    bool takeTask(int home, Task& task);
+    bool takeBatchTask(int home, const Batch& batch, Task& task);
+    void runTask(const Task& task);
+    void workerLoop(int id);
+
+    std::vector<std::unique_ptr<Queue>> queues;  // one per worker, the last for outside threads
+    std::vector<std::thread> workers;
+    std::atomic<int> queued{0};
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+// The process-wide pool, started on first use with the thread count last
+// given to setSharedPoolThreads() (default 0, one per hardware thread).
+ThreadPool& sharedPool();
+// False once sharedPool() has started; the count can no longer change then.
+bool setSharedPoolThreads(int threads);
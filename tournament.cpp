@@ -0,0 +1,140 @@
+#include "tournament.h"
+
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const int GAMES_PER_CLAIM = 16;
+
+int sideIndex(CellState side) {
+    return side == CellState::PLAYER ? 0 : 1;
+}
+
+// keeps each worker's counters on their own cache line
+struct alignas(64) WorkerStats {
+    MatchStats stats;
+};
+
+}
+
+void MatchStats::recordMove(CellState side, const Move& move) {
+    int s = sideIndex(side);
+    switch (move.type) {
+        case MoveType::CAPTURE: captures[s]++; break;
+        case MoveType::ATTACK: attacks[s]++; break;
+        case MoveType::SPEED: speeds[s]++; break;
+        case MoveType::PASS: passes[s]++; break;
+    }
+}
+
+void MatchStats::recordGame(const GameState& state) {
+    switch (state.outcome) {
+        case GameResult::PLAYER_WIN: playerWins++; break;
+        case GameResult::AI_WIN: aiWins++; break;
+        case GameResult::DRAW: draws++; break;
+        case GameResult::NONE: unfinished++; break;
+    }
+    shortest = games == 0 ? state.turn : std::min(shortest, state.turn);
+    longest = std::max(longest, state.turn);
+    turns += state.turn;
+    games++;
+}
+
+void MatchStats::merge(const MatchStats& other) {
+    if (other.games == 0) return;
+    shortest = games == 0 ? other.shortest : std::min(shortest, other.shortest);
+    longest = std::max(longest, other.longest);
+    games += other.games;
+    playerWins += other.playerWins;
+    aiWins += other.aiWins;
+    draws += other.draws;
+    unfinished += other.unfinished;
+    turns += other.turns;
+    for (int s = 0; s < 2; s++) {
+        captures[s] += other.captures[s];
+        attacks[s] += other.attacks[s];
+        speeds[s] += other.speeds[s];
+        passes[s] += other.passes[s];
+    }
+}
+
+void seedGame(std::mt19937& rng, uint32_t seed, long long gameIndex) {
+    std::seed_seq sequence{seed, static_cast<uint32_t>(gameIndex), static_cast<uint32_t>(gameIndex >> 32)};
+    rng.seed(sequence);
+}
+
+void playGame(GameState& state, const Rules& rules, int maxTurns,
+              Agent& player, Agent& ai, std::mt19937& rng, MatchStats& stats,
+              ReplayEncoder* replay) {
+    state.reset(rules);
+    while (!state.isOver() && state.turn < maxTurns) {
+        CellState side = state.toMove;
+        Agent& agent = side == CellState::PLAYER ? player : ai;
+        Move move = agent.chooseMove(state, rng);
+        if (!applyMove(state, move)) {
+            move = Move::pass();
+            applyPass(state);
+        }
+        stats.recordMove(side, move);
+        if (replay) replay->move(move);
+    }
+    stats.recordGame(state);
+}
+
+MatchStats runTournament(const TournamentConfig& config, double* elapsedSeconds) {
+    ThreadPool& pool = config.pool ? *config.pool : sharedPool();
+    int threads = config.threads > 0 ? config.threads : pool.concurrency();
+    threads = std::max(1, std::min(threads, std::max(1, config.games)));
+    int maxTurns = config.maxTurns > 0 ? config.maxTurns : 4 * config.rules.gridSize * config.rules.gridSize;
+
+    std::atomic<long long> nextGame{0};
+    std::vector<WorkerStats> workerStats(threads);
+    std::mutex recordLock;
+
+    auto worker = [&](int id) {
+        std::unique_ptr<Agent> player = config.playerAgent();
+        std::unique_ptr<Agent> ai = config.aiAgent();
+        std::mt19937 rng;
+        GameState state;
+        MatchStats& stats = workerStats[id].stats;
+        ReplayEncoder replay;
+
+        while (true) {
+            long long first = nextGame.fetch_add(GAMES_PER_CLAIM, std::memory_order_relaxed);
+            if (first >= config.games) break;
+            long long last = std::min<long long>(first + GAMES_PER_CLAIM, config.games);
+            for (long long game = first; game < last; game++) {
+                seedGame(rng, config.seed, game);
+                if (!config.record) {
+                    playGame(state, config.rules, maxTurns, *player, *ai, rng, stats);
+                    continue;
+                }
+
+                replay.beginGame(config.rules, config.seed, static_cast<uint64_t>(game));
+                playGame(state, config.rules, maxTurns, *player, *ai, rng, stats, &replay);
+                replay.endGame(state.outcome);
+                std::lock_guard<std::mutex> lock(recordLock);
+                config.record->append(replay);
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(threads, worker);
+    auto end = std::chrono::steady_clock::now();
+
+    if (elapsedSeconds) {
+        *elapsedSeconds = std::chrono::duration<double>(end - start).count();
+    }
+
+    MatchStats total;
+    for (const WorkerStats& stats : workerStats) {
+        total.merge(stats.stats);
+    }
+    return total;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "agent.h"
+#include "replay.h"
+#include "rules.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+class ThreadPool;
+
+using AgentFactory = std::function<std::unique_ptr<Agent>()>;
+
+struct TournamentConfig {
+    Rules rules;
+    int games = 1000;
+    int threads = 0;        // games played at once, 0 = one per pool thread
+    ThreadPool* pool = nullptr;  // nullptr = sharedPool()
+    uint32_t seed = 1;
+    int maxTurns = 0;       // 0 = four turns per cell
+    AgentFactory playerAgent;
+    AgentFactory aiAgent;
+    ReplayFile* record = nullptr;  // if set, every game is appended to it
+};
+
+// Per-side counters are indexed 0 = PLAYER, 1 = AI.
+struct MatchStats {
+    long long games = 0;
+    long long playerWins = 0;
+    long long aiWins = 0;
+    long long draws = 0;
+    long long unfinished = 0;
+    long long turns = 0;
+    int shortest = 0;
+    int longest = 0;
+    long long captures[2] = {0, 0};
+    long long attacks[2] = {0, 0};
+    long long speeds[2] = {0, 0};
+    long long passes[2] = {0, 0};
+
+    void recordMove(CellState side, const Move& move);
+    void recordGame(const GameState& state);
+    void merge(const MatchStats& other);
+};
+
+// Seeds the RNG for one game from the tournament seed and the game index, so
+// every game replays identically regardless of which worker ran it.
+void seedGame(std::mt19937& rng, uint32_t seed, long long gameIndex);
+
+// Plays one game to completion or to maxTurns, recording into stats and, if
+// given, the moves into replay's open game.
+void playGame(GameState& state, const Rules& rules, int maxTurns,
+              Agent& player, Agent& ai, std::mt19937& rng, MatchStats& stats,
+              ReplayEncoder* replay = nullptr);
+
+// Plays config.games games across config.threads workers, as one batch on
+// the pool. Each worker owns its state, agents, RNG and stats; the only
+// shared writes are a game counter and, when recording, appending each
+// finished game to the log. Agents that search in parallel use the same
+// pool, so running fewer games at once than the pool has threads leaves the
+// rest to their searches.
+MatchStats runTournament(const TournamentConfig& config, double* elapsedSeconds = nullptr);
@@ -0,0 +1,176 @@
+#include "agent_registry.h"
+#include "tablebase.h"
+#include "thread_pool.h"
+#include "tournament.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::printf("usage: %s [options]\n"
+                "  --games N           games to play (default 1000)\n"
+                "  --threads N         pool threads, 0 = all cores (default 0)\n"
+                "  --parallel-games N  games played at once, 0 = one per thread (default 0)\n"
+                "  --size N            board size (default %d)\n"
+                "  --impulse-cost N    charges per impulse (default %d)\n"
+                "  --win-percentage N  share of the board needed to win (default %d)\n"
+                "  --max-turns N       turn cap per game, 0 = 4 per cell (default 0)\n"
+                "  --seed N            tournament seed (default 1)\n"
+                "  --player NAME       agent playing PLAYER (default random)\n"
+                "  --ai NAME           agent playing AI (default random)\n"
+                "  --tablebase FILE    MCTS agents play solved 7x7 endgames from it\n"
+                "  --record FILE       append every game to a replay log\n"
+                "  --replay FILE       replay and summarise a log instead of playing\n"
+                "agents: %s\n",
+                program, DEFAULT_GRID_SIZE, IMPULSE_COST, WIN_PERCENTAGE, agentNames());
+}
+
+double percent(long long part, long long whole) {
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+// Decodes every game of a log and plays it back through the rules, without
+// running any agent.
+int summariseReplay(const char* path) {
+    ReplayMap log;
+    if (!log.open(path)) {
+        std::fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    ReplayReader reader = log.reader();
+    if (!reader.valid()) {
+        std::fprintf(stderr, "%s is not a replay log\n", path);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ReplayGame game;
+    GameState state;
+    long long games = 0;
+    long long moves = 0;
+    long long rejected = 0;
+    long long mismatched = 0;
+    long long outcomes[4] = {0, 0, 0, 0};
+    while (reader.next(game)) {
+        games++;
+        moves += static_cast<long long>(game.moves.size());
+        outcomes[static_cast<int>(game.outcome)]++;
+        if (!replayGame(game, state)) rejected++;
+        else if (state.outcome != game.outcome) mismatched++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%s: %lld games, %lld moves, %.2f bytes/move, replayed in %.2fs (%.0f MB/s)%s\n", path,
+                games, moves, moves > 0 ? static_cast<double>(log.size()) / moves : 0.0, seconds,
+                seconds > 0 ? log.size() / seconds / 1e6 : 0.0, reader.truncated() ? ", last game truncated" : "");
+    std::printf("  player wins %lld  ai wins %lld  draws %lld  unfinished %lld\n",
+                outcomes[static_cast<int>(GameResult::PLAYER_WIN)], outcomes[static_cast<int>(GameResult::AI_WIN)],
+                outcomes[static_cast<int>(GameResult::DRAW)], outcomes[static_cast<int>(GameResult::NONE)]);
+    if (rejected > 0 || mismatched > 0) {
+        std::printf("  %lld games with illegal moves, %lld with a different result\n", rejected, mismatched);
+        return 1;
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    TournamentConfig config;
+    std::string playerName = "random";
+    std::string aiName = "random";
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    int poolThreads = 0;
+    const char* tablebasePath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", arg);
+            return 1;
+        }
+        const char* value = argv[++i];
+
+        if (std::strcmp(arg, "--games") == 0) config.games = std::atoi(value);
+        else if (std::strcmp(arg, "--threads") == 0) poolThreads = std::atoi(value);
+        else if (std::strcmp(arg, "--parallel-games") == 0) config.threads = std::atoi(value);
+        else if (std::strcmp(arg, "--size") == 0) config.rules.gridSize = std::atoi(value);
+        else if (std::strcmp(arg, "--impulse-cost") == 0) config.rules.impulseCost = std::atoi(value);
+        else if (std::strcmp(arg, "--win-percentage") == 0) config.rules.winPercentage = std::atoi(value);
+        else if (std::strcmp(arg, "--max-turns") == 0) config.maxTurns = std::atoi(value);
+        else if (std::strcmp(arg, "--seed") == 0) config.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--player") == 0) playerName = value;
+        else if (std::strcmp(arg, "--ai") == 0) aiName = value;
+        else if (std::strcmp(arg, "--tablebase") == 0) tablebasePath = value;
+        else if (std::strcmp(arg, "--record") == 0) recordPath = value;
+        else if (std::strcmp(arg, "--replay") == 0) replayPath = value;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (replayPath) {
+        return summariseReplay(replayPath);
+    }
+
+    if (config.rules.gridSize < 2 || config.games < 1) {
+        std::fprintf(stderr, "need --size >= 2 and --games >= 1\n");
+        return 1;
+    }
+
+    Tablebase tablebase;
+    if (tablebasePath && !tablebase.open(tablebasePath)) {
+        std::fprintf(stderr, "cannot read tablebase %s\n", tablebasePath);
+        return 1;
+    }
+    const Tablebase* solved = tablebase.loaded() ? &tablebase : nullptr;
+    config.playerAgent = findAgent(playerName, solved);
+    config.aiAgent = findAgent(aiName, solved);
+    if (!config.playerAgent || !config.aiAgent) {
+        std::fprintf(stderr, "unknown agent; expected one of: %s\n", agentNames());
+        return 1;
+    }
+
+    setSharedPoolThreads(poolThreads);
+
+    ReplayFile record;
+    if (recordPath) {
+        if (!record.open(recordPath)) {
+            std::fprintf(stderr, "cannot append to %s\n", recordPath);
+            return 1;
+        }
+        config.record = &record;
+    }
+
+    double seconds = 0.0;
+    MatchStats stats = runTournament(config, &seconds);
+
+    std::printf("%s (PLAYER) vs %s (AI), %dx%d, %lld games in %.2fs (%.1f games/s)\n",
+                playerName.c_str(), aiName.c_str(), config.rules.gridSize, config.rules.gridSize,
+                stats.games, seconds, seconds > 0 ? stats.games / seconds : 0.0);
+    std::printf("  player wins %lld (%.1f%%)  ai wins %lld (%.1f%%)  draws %lld (%.1f%%)  unfinished %lld\n",
+                stats.playerWins, percent(stats.playerWins, stats.games),
+                stats.aiWins, percent(stats.aiWins, stats.games),
+                stats.draws, percent(stats.draws, stats.games), stats.unfinished);
+    std::printf("  turns: avg %.1f  min %d  max %d\n",
+                stats.games > 0 ? static_cast<double>(stats.turns) / stats.games : 0.0,
+                stats.shortest, stats.longest);
+    const char* sides[2] = {"player", "ai"};
+    for (int s = 0; s < 2; s++) {
+        std::printf("  %-6s captures %lld  attacks %lld  speeds %lld  passes %lld\n", sides[s],
+                    stats.captures[s], stats.attacks[s], stats.speeds[s], stats.passes[s]);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "transposition.h"
+
+#include <cstring>
+
+namespace {
+
+uint64_t pack(const TableEntry& entry) {
+    uint32_t valueBits;
+    std::memcpy(&valueBits, &entry.value, sizeof(valueBits));
+    return (static_cast<uint64_t>(entry.visits) << 32) | valueBits;
+}
+
+TableEntry unpack(uint64_t data) {
+    TableEntry entry;
+    entry.visits = static_cast<uint32_t>(data >> 32);
+    uint32_t valueBits = static_cast<uint32_t>(data);
+    std::memcpy(&entry.value, &valueBits, sizeof(valueBits));
+    return entry;
+}
+
+}
+
+TranspositionTable::TranspositionTable(int sizeBits)
+    : slots(new Slot[size_t(1) << sizeBits]), mask((uint64_t(1) << sizeBits) - 1) {}
+
+bool TranspositionTable::probe(uint64_t key, TableEntry& entry) const {
+    const Slot& slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || data == 0) return false;
+    entry = unpack(data);
+    return entry.visits > 0;
+}
+
+void TranspositionTable::store(uint64_t key, const TableEntry& entry) {
+    Slot& slot = slots[key & mask];
+    uint64_t previous = slot.data.load(std::memory_order_relaxed);
+    uint64_t previousKey = slot.check.load(std::memory_order_relaxed) ^ previous;
+    if (previousKey != key && entry.visits < unpack(previous).visits) return;
+
+    uint64_t data = pack(entry);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < size(); i++) {
+        slots[i].data.store(0, std::memory_order_relaxed);
+        slots[i].check.store(0, std::memory_order_relaxed);
+    }
+}
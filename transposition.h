@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+const int DEFAULT_TABLE_BITS = 16;  // 2^16 slots, 1 MiB
+
+// What a search learned about one position.
+struct TableEntry {
+    uint32_t visits = 0;  // search effort behind value; doubles as the depth
+    float value = 0.0f;   // mean reward for the side that moved into the position
+};
+
+// Fixed-size transposition table that any number of search threads can share
+// without locks. Each slot holds the packed entry and key ^ entry as two
+// relaxed atomics, so a slot torn by concurrent stores fails the key check
+// and reads back as a miss rather than as a blend of two positions.
+// Replacement is by depth: a slot keeps the entry with more visits behind
+// it, except that updates for the position already stored always land.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(int sizeBits = DEFAULT_TABLE_BITS);
+
+    bool probe(uint64_t key, TableEntry& entry) const;
+    void store(uint64_t key, const TableEntry& entry);
+    void clear();
+
+    size_t size() const { return static_cast<size_t>(mask) + 1; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+// Zobrist keys, derived on demand from a fixed mixing function instead of
+// being looked up in a random table, so boards up to 1024x1024 pay nothing
+// for them. A position's key is the XOR of the keys of every owned cell, the
+// side-to-move key when the AI is to move, and one key per side's charges.
+
+inline uint64_t zobristMix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// side: 0 for PLAYER, 1 for AI
+inline uint64_t zobristCell(int index, int side) {
+    return zobristMix(static_cast<uint64_t>(index) * 2 + side);
+}
+
+inline uint64_t zobristAiToMove() {
+    return zobristMix(0xa1a1a1a1a1a1a1a1ull);
+}
+
+inline uint64_t zobristCharges(int side, int charges) {
+    return zobristMix((uint64_t(1) << 62) + static_cast<uint64_t>(charges) * 2 + side);
+}